@@ -0,0 +1,203 @@
+//
+// bench.c
+// Developed by the GAME2 Team.
+// Reproducible engine benchmark: searches a fixed corpus of positions at fixed depths and reports
+// nodes/sec, evaluations/sec, transposition table hit rate and time-to-depth (optionally as JSON).
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "bot.h"
+#include "zobrist.h"
+
+typedef struct Position {
+    const char* name;
+    char player;
+    const char* cells;
+} Position;
+
+// positions from seeded self-play games (openings, middle games and tactical positions)
+static const Position corpus[] = {
+    {"opening_a", 'O', "---------------------------------O---------O-X--------X---------------------------------------------"},
+    {"opening_b", 'X', "------------------------------------OX-------X-O---------O------------------------------------------"},
+    {"opening_c", 'O', "---------------------------------XOX-------XO---------------O---------------------------------------"},
+    {"middle_a", 'X', "-----------------------O---------O---------O-X------XXXO-------O------------------------------------"},
+    {"middle_b", 'O', "-------------------------X---------XOX-------X-O------XOOO------------------------------------------"},
+    {"middle_c", 'X', "-----------------------OO-------OXOX-------XO---------X-----O----X----------------------------------"},
+    {"tactical_a", 'X', "----O--------X--------XO-------X-O--------OOOX------XXXO-------O------------------------------------"},
+    {"tactical_b", 'O', "-------------------------X---------XOX------XXXO------XOOO--------OO---------O---------X------------"},
+    {"late_a", 'X', "----O--------X--------XOX------X-O-O-----XOOOXX----OXXXO-------OO-----------------------------------"},
+};
+#define N_OF_POSITIONS (int)(sizeof(corpus) / sizeof(corpus[0]))
+
+typedef struct Result {
+    int move;
+    int score;
+    long long nodes;
+    long long evaluations;
+    long long t_t_probes;
+    long long t_t_hits;
+    double seconds; // best of the repetitions
+    double time_to_depth[MAX_SEARCH_DEPTH + 1]; // seconds until each depth was completed (best of the repetitions)
+} Result;
+
+static double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+// loads a corpus position
+static Board load(const Position* position) {
+    Board board = {0};
+    for (int i = 0; i < BOARD_SIZE*BOARD_SIZE; i++)
+        if (position->cells[i] != EMPTY)
+            place_piece(&board, i % BOARD_SIZE, i / BOARD_SIZE, position->cells[i]);
+    return board;
+}
+
+// searches a position from cold caches with iterative deepening up to depth
+static void run(const Position* position, const int depth, const uint32_t seed, Result* result, const bool first) {
+    const Board board = load(position);
+    clear_bot();
+    seed_random(seed);
+    long long total_nodes = 0, total_evaluations = 0, total_probes = 0, total_hits = 0;
+    int move = -1, score = 0;
+    const double start = now();
+    for (int d = 1; d <= depth; d++) { // same iterations as iterative_deepening_search
+        if (d > 1) reset_bot();
+        move = bot_search(&board, position->player, d, 0, &score);
+        total_nodes += search_stats.nodes;
+        total_evaluations += search_stats.evaluations;
+        total_probes += search_stats.t_t_probes;
+        total_hits += search_stats.t_t_hits;
+        const double elapsed = now() - start;
+        if (first || elapsed < result->time_to_depth[d]) result->time_to_depth[d] = elapsed;
+    }
+    const double seconds = now() - start;
+    if (first || seconds < result->seconds) result->seconds = seconds;
+    // counters are deterministic, only time changes between repetitions
+    result->move = move;
+    result->score = score;
+    result->nodes = total_nodes;
+    result->evaluations = total_evaluations;
+    result->t_t_probes = total_probes;
+    result->t_t_hits = total_hits;
+}
+
+static double ratio(const double a, const double b) {
+    return b > 0 ? a / b : 0;
+}
+
+static void print_json(FILE* out, const int* depths, const int n_of_depths, Result results[][N_OF_POSITIONS],
+                       const uint32_t seed, const int repetitions, const int t_t_cap) {
+    fprintf(out, "{\n  \"benchmark\": \"gomoku_bench\",\n");
+    fprintf(out, "  \"compiler\": \"%s\",\n", __VERSION__);
+    fprintf(out, "  \"config\": {\"seed\": %u, \"repetitions\": %d, \"t_t_cap\": %d, \"eval_cache_cap\": %d},\n",
+            seed, repetitions, t_t_cap, EVAL_CACHE_CAP);
+    fprintf(out, "  \"runs\": [\n");
+    for (int d = 0; d < n_of_depths; d++) {
+        long long nodes_sum = 0, evaluations_sum = 0, probes_sum = 0, hits_sum = 0;
+        double seconds_sum = 0;
+        fprintf(out, "    {\"depth\": %d, \"positions\": [\n", depths[d]);
+        for (int p = 0; p < N_OF_POSITIONS; p++) {
+            const Result* r = &results[d][p];
+            fprintf(out, "      {\"name\": \"%s\", \"move\": %d, \"score\": %d, \"nodes\": %lld, \"evaluations\": %lld, "
+                         "\"t_t_probes\": %lld, \"t_t_hits\": %lld, \"t_t_hit_rate\": %.4f, \"seconds\": %.6f, "
+                         "\"nodes_per_sec\": %.0f, \"evaluations_per_sec\": %.0f, \"time_to_depth\": [",
+                    corpus[p].name, r->move, r->score, r->nodes, r->evaluations, r->t_t_probes, r->t_t_hits,
+                    ratio(r->t_t_hits, r->t_t_probes), r->seconds, ratio(r->nodes, r->seconds), ratio(r->evaluations, r->seconds));
+            for (int i = 1; i <= depths[d]; i++)
+                fprintf(out, "%s%.6f", i > 1 ? ", " : "", r->time_to_depth[i]);
+            fprintf(out, "]}%s\n", p < N_OF_POSITIONS - 1 ? "," : "");
+            nodes_sum += r->nodes;
+            evaluations_sum += r->evaluations;
+            probes_sum += r->t_t_probes;
+            hits_sum += r->t_t_hits;
+            seconds_sum += r->seconds;
+        }
+        fprintf(out, "    ], \"total\": {\"nodes\": %lld, \"evaluations\": %lld, \"t_t_hit_rate\": %.4f, \"seconds\": %.6f, "
+                     "\"nodes_per_sec\": %.0f, \"evaluations_per_sec\": %.0f}}%s\n",
+                nodes_sum, evaluations_sum, ratio(hits_sum, probes_sum), seconds_sum,
+                ratio(nodes_sum, seconds_sum), ratio(evaluations_sum, seconds_sum), d < n_of_depths - 1 ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -d depth    benchmark a single depth (default: 5 and 7, max %d)\n"
+        "  -r count    repetitions per position, the fastest is reported (default 3)\n"
+        "  -s seed     random seed (default 1)\n"
+        "  -T entries  transposition table capacity (default 15000)\n"
+        "  -q 0|1      quiescence search (default 1)\n"
+        "  -m 0|1      better move ordering (default 1)\n"
+        "  -c          symmetry-canonical transposition table keys\n"
+        "  -j file     write results as JSON ('-' for stdout)\n",
+        name, MAX_SEARCH_DEPTH);
+}
+
+int main(const int argc, char** argv) {
+    int depths[2] = {5, 7};
+    int n_of_depths = 2;
+    int repetitions = 3, t_t_cap = 15000, opt;
+    uint32_t seed = 1;
+    bool quiescence = true, move_order = true, canonical = false;
+    const char* json_path = NULL;
+    while ((opt = getopt(argc, argv, "d:r:s:T:q:m:cj:h")) != -1) {
+        switch (opt) {
+            case 'd': depths[0] = atoi(optarg); n_of_depths = 1; break;
+            case 'r': repetitions = atoi(optarg); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            case 'T': t_t_cap = atoi(optarg); break;
+            case 'q': quiescence = atoi(optarg) != 0; break;
+            case 'm': move_order = atoi(optarg) != 0; break;
+            case 'c': canonical = true; break;
+            case 'j': json_path = optarg; break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (depths[0] < 1 || depths[0] > MAX_SEARCH_DEPTH || repetitions < 1 || t_t_cap < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    seed_random(seed); // zobrist keys come from the seed too
+    init_bot(t_t_cap);
+    set_do_quiescence(quiescence);
+    set_better_move_order(move_order);
+    set_canonical_t_t(canonical);
+
+    static Result results[2][N_OF_POSITIONS];
+    FILE* log = json_path != NULL && strcmp(json_path, "-") == 0 ? stderr : stdout;
+    for (int d = 0; d < n_of_depths; d++) {
+        fprintf(log, "depth %d\n%-12s %5s %9s %10s %10s %11s %7s %9s\n", depths[d],
+                "position", "move", "score", "nodes", "nodes/s", "evals/s", "t_t hit", "time ms");
+        for (int p = 0; p < N_OF_POSITIONS; p++) {
+            for (int r = 0; r < repetitions; r++)
+                run(&corpus[p], depths[d], seed, &results[d][p], r == 0);
+            const Result* res = &results[d][p];
+            fprintf(log, "%-12s %5d %9d %10lld %10.0f %11.0f %6.1f%% %9.2f\n", corpus[p].name, res->move, res->score,
+                    res->nodes, ratio(res->nodes, res->seconds), ratio(res->evaluations, res->seconds),
+                    100 * ratio(res->t_t_hits, res->t_t_probes), res->seconds * 1000);
+        }
+    }
+
+    if (json_path != NULL) {
+        FILE* out = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (out == NULL) {
+            perror(json_path);
+            free_bot();
+            return 1;
+        }
+        print_json(out, depths, n_of_depths, results, seed, repetitions, t_t_cap);
+        if (out != stdout) fclose(out);
+    }
+    free_bot();
+    return 0;
+}
@@ -0,0 +1,162 @@
+//
+// cli.c
+// Developed by the GAME2 Team.
+// Host command line front end for the engine: loads a position, searches it and prints the result.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "bot.h"
+#include "profile.h"
+#include "trace.h"
+#include "zobrist.h"
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "usage: %s [options] [position file]\n"
+        "  position: 100 cells of '-' (or '.'), 'O' (white) and 'X' (black), row by row;\n"
+        "            any other character is ignored, so print_board output can be pasted.\n"
+        "            Read from stdin when no file and no -b is given.\n"
+        "  -b cells    position given on the command line\n"
+        "  -p O|X      player to move (default: the side with fewer pieces, O on ties)\n"
+        "  -d depth    search depth (default 5, max %d)\n"
+        "  -t ms       time limit, searches with iterative deepening up to the depth\n"
+        "  -T entries  transposition table capacity (default 15000)\n"
+        "  -q 0|1      quiescence search (default 1)\n"
+        "  -m 0|1      better move ordering (default 1)\n"
+        "  -c          symmetry-canonical transposition table keys\n"
+        "  -i 0|1      explicit stack search, 0 = recursive reference (default 1)\n"
+        "  -s seed     random seed (default 1)\n"
+#ifdef GOMOKU_TRACE
+        "  -o file     write a search trace (read with gomoku_trace)\n"
+#endif
+        "  -v          print the board before searching\n",
+        name, MAX_SEARCH_DEPTH);
+}
+
+// reads a position from text, returns false if it doesn't hold exactly 100 cells
+static bool parse_board(const char* text, Board* board) {
+    int cell = 0;
+    for (const char* c = text; *c != '\0'; c++) {
+        char piece;
+        switch (*c) {
+            case '-': case '.': piece = EMPTY; break;
+            case 'O': case 'o': piece = WHITE; break;
+            case 'X': case 'x': piece = BLACK; break;
+            default: continue;
+        }
+        if (cell >= BOARD_SIZE*BOARD_SIZE) return false;
+        if (piece != EMPTY) place_piece(board, cell % BOARD_SIZE, cell / BOARD_SIZE, piece);
+        cell++;
+    }
+    return cell == BOARD_SIZE*BOARD_SIZE;
+}
+
+// reads a whole stream into a string
+static char* read_all(FILE* file) {
+    size_t len = 0, cap = 1024;
+    char* text = malloc(cap);
+    size_t n;
+    while ((n = fread(text + len, 1, cap - len - 1, file)) > 0) {
+        len += n;
+        if (cap - len - 1 == 0) text = realloc(text, cap *= 2);
+    }
+    text[len] = '\0';
+    return text;
+}
+
+int main(const int argc, char** argv) {
+    const char* cells = NULL;
+    char player = '\0';
+    int depth = 5, time_limit_ms = 0, t_t_cap = 15000, opt;
+    bool quiescence = true, move_order = true, canonical = false, iterative = true, verbose = false;
+    unsigned int seed = 1;
+    const char* trace_path = NULL;
+    while ((opt = getopt(argc, argv, "b:p:d:t:T:q:m:ci:s:o:vh")) != -1) {
+        switch (opt) {
+            case 'b': cells = optarg; break;
+            case 'p': player = optarg[0] == 'x' || optarg[0] == 'X' ? BLACK : WHITE; break;
+            case 'd': depth = atoi(optarg); break;
+            case 't': time_limit_ms = atoi(optarg); break;
+            case 'T': t_t_cap = atoi(optarg); break;
+            case 'q': quiescence = atoi(optarg) != 0; break;
+            case 'm': move_order = atoi(optarg) != 0; break;
+            case 'c': canonical = true; break;
+            case 'i': iterative = atoi(optarg) != 0; break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            case 'o': trace_path = optarg; break;
+            case 'v': verbose = true; break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (depth < 1 || depth > MAX_SEARCH_DEPTH || t_t_cap < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    char* text = NULL;
+    if (cells == NULL) {
+        FILE* file = optind < argc ? fopen(argv[optind], "r") : stdin;
+        if (file == NULL) {
+            perror(argv[optind]);
+            return 1;
+        }
+        text = read_all(file);
+        if (file != stdin) fclose(file);
+        cells = text;
+    }
+    Board board = {0};
+    if (!parse_board(cells, &board)) {
+        fprintf(stderr, "position must have %d cells\n", BOARD_SIZE*BOARD_SIZE);
+        free(text);
+        return 1;
+    }
+    free(text);
+
+    seed_random(seed);
+    init_bot(t_t_cap);
+    set_do_quiescence(quiescence);
+    set_better_move_order(move_order);
+    set_canonical_t_t(canonical);
+    set_iterative_search(iterative);
+    if (player == '\0') player = count1s(board.white) > count1s(board.black) ? BLACK : WHITE;
+    if (verbose) print_board(&board);
+    if (check_winner(&board) != '\0') {
+        fprintf(stderr, "game is already over\n");
+        free_bot();
+        return 1;
+    }
+
+#ifdef GOMOKU_TRACE
+    if (trace_path != NULL && !trace_open(trace_path)) {
+        perror(trace_path);
+        free_bot();
+        return 1;
+    }
+#else
+    if (trace_path != NULL) fprintf(stderr, "built without GOMOKU_TRACE, -o ignored\n");
+#endif
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int score = 0;
+    const int move = bot_search(&board, player, depth, time_limit_ms, &score);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+#ifdef GOMOKU_TRACE
+    trace_close();
+#endif
+    const double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("player:      %c\n", player);
+    printf("move:        %d (x %d, y %d)\n", move, move % BOARD_SIZE, move / BOARD_SIZE);
+    printf("score:       %d\n", score);
+    printf("nodes/s:     %.0f\n", seconds > 0 ? search_stats.nodes / seconds : 0);
+    print_search_stats(&search_stats);
+    PROFILE_PRINT();
+    printf("t_table size: %d\n", transposition_table.size);
+    free_bot();
+    return 0;
+}
@@ -0,0 +1,423 @@
+//
+// diffcheck.c
+// Developed by the GAME2 Team.
+// Differential checker: runs engine kernels against reference oracles on random and self-play positions,
+// across all cores, and reports the first mismatching position.
+// To rewrite a kernel, keep the current implementation here as the reference (reference_<name>) and
+// compare the new one against it in a check below.
+//
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "bot.h"
+#include "zobrist.h"
+
+#define MAX_WORKERS 64
+#define REPORT_LEN 1536
+#define BATCH 4096 // positions between progress reports of a worker
+#define SEARCH_CHECK_DEPTH 3
+#define SEARCH_CHECK_T_T_CAP 4096
+#define SEARCH_CHECK_EVERY 1000 // default: the search check runs on 1 position in 1000, the kernel checks keep their rate
+
+// message from a worker to the parent
+typedef struct WorkerReport {
+    long long checked;   // positions checked since the last report
+    bool mismatch;
+    bool done;
+    char text[REPORT_LEN]; // mismatch description
+} WorkerReport;
+
+// a check returns false and describes the mismatch in detail (REPORT_LEN bytes)
+typedef bool (*check_fn)(const Board* board, char player, char* detail);
+
+typedef struct Check {
+    const char* name;
+    check_fn check;
+    bool sampled; // a whole search, only run every search_every positions
+} Check;
+
+static SearchPly ply;
+static long long search_every = SEARCH_CHECK_EVERY;
+
+static void describe(char* detail, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(detail, REPORT_LEN, format, args);
+    va_end(args);
+}
+
+// reference oracles: straightforward cell by cell versions of the current semantics
+
+// first five in a row by direction (horizontal, vertical, diagonal forward, diagonal back), white before black
+static char reference_check_winner(const Board* board) {
+    static const int dx[4] = {1, 0, 1, 1}, dy[4] = {0, 1, -1, 1};
+    for (int dir = 0; dir < 4; dir++) {
+        for (int p = 0; p < 2; p++) {
+            const char player = p == 0 ? WHITE : BLACK;
+            for (int y = 0; y < BOARD_SIZE; y++) {
+                for (int x = 0; x < BOARD_SIZE; x++) {
+                    int n = 0;
+                    while (n < 5) {
+                        const int cx = x + n * dx[dir], cy = y + n * dy[dir];
+                        if (cx < 0 || cx >= BOARD_SIZE || cy < 0 || cy >= BOARD_SIZE || get(board, cx, cy) != player) break;
+                        n++;
+                    }
+                    if (n == 5) return player;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < BOARD_SIZE*BOARD_SIZE; i++)
+        if (get(board, i % BOARD_SIZE, i / BOARD_SIZE) == EMPTY) return '\0';
+    return EMPTY;
+}
+
+// winners in any direction (a random board can have both)
+static bool has_five(const Board* board, const char player) {
+    static const int dx[4] = {1, 0, 1, 1}, dy[4] = {0, 1, -1, 1};
+    for (int y = 0; y < BOARD_SIZE; y++)
+        for (int x = 0; x < BOARD_SIZE; x++)
+            for (int dir = 0; dir < 4; dir++) {
+                int n = 0;
+                while (n < 5) {
+                    const int cx = x + n * dx[dir], cy = y + n * dy[dir];
+                    if (cx < 0 || cx >= BOARD_SIZE || cy < 0 || cy >= BOARD_SIZE || get(board, cx, cy) != player) break;
+                    n++;
+                }
+                if (n == 5) return true;
+            }
+    return false;
+}
+
+// empty cells next to a piece (1 on an empty board)
+static int reference_count_next_moves(const Board* board) {
+    int count = 0, pieces = 0;
+    for (int y = 0; y < BOARD_SIZE; y++) {
+        for (int x = 0; x < BOARD_SIZE; x++) {
+            if (get(board, x, y) != EMPTY) {
+                pieces++;
+                continue;
+            }
+            bool neighbor = false;
+            for (int ny = y - 1; ny <= y + 1; ny++)
+                for (int nx = x - 1; nx <= x + 1; nx++)
+                    if (nx >= 0 && nx < BOARD_SIZE && ny >= 0 && ny < BOARD_SIZE && get(board, nx, ny) != EMPTY)
+                        neighbor = true;
+            count += neighbor;
+        }
+    }
+    return pieces == 0 ? 1 : count;
+}
+
+// checks
+
+static bool check_evaluate_board(const Board* board, const char player, char* detail) {
+    const int reference = static_evaluation(board);
+    const int first = evaluate_board(board); // miss or hit
+    const int second = evaluate_board(board); // hit
+    if (first == reference && second == reference) return true;
+    describe(detail, "evaluate_board %d/%d (miss/hit), static_evaluation %d", first, second, reference);
+    return false;
+}
+
+static bool check_check_winner(const Board* board, const char player, char* detail) {
+    const char candidate = check_winner(board);
+    const char reference = reference_check_winner(board);
+    if (candidate == reference) return true;
+    // both players can have five on a random board, any of them is a valid answer
+    if ((candidate == WHITE || candidate == BLACK) && has_five(board, WHITE) && has_five(board, BLACK)) return true;
+    describe(detail, "check_winner '%c', reference '%c'", candidate ? candidate : '0', reference ? reference : '0');
+    return false;
+}
+
+static bool check_count_next_moves(const Board* board, const char player, char* detail) {
+    const int candidate = count_next_moves(board), reference = reference_count_next_moves(board);
+    if (candidate == reference) return true;
+    describe(detail, "count_next_moves %d, reference %d", candidate, reference);
+    return false;
+}
+
+// evaluation is the same for every rotation/reflection of a board
+static bool check_evaluation_symmetry(const Board* board, const char player, char* detail) {
+    if (has_five(board, WHITE) && has_five(board, BLACK)) return true; // winner depends on the scan order
+    const int reference = static_evaluation(board);
+    for (int sym = 1; sym < N_OF_SYMMETRIES; sym++) {
+        Board transformed;
+        transform_board(board, &transformed, sym);
+        const int candidate = static_evaluation(&transformed);
+        if (candidate != reference) {
+            describe(detail, "static_evaluation %d, symmetry %d gives %d", reference, sym, candidate);
+            return false;
+        }
+    }
+    return true;
+}
+
+// move scores are the same for every rotation/reflection of a board
+static bool check_evaluate_move(const Board* board, const char player, char* detail) {
+    for (int move = 0; move < BOARD_SIZE*BOARD_SIZE; move++) {
+        if (!is_next_position(board, move % BOARD_SIZE, move / BOARD_SIZE)) continue;
+        const int reference = evaluate_move(board, move % BOARD_SIZE, move / BOARD_SIZE, player);
+        for (int sym = 1; sym < N_OF_SYMMETRIES; sym++) {
+            Board transformed;
+            transform_board(board, &transformed, sym);
+            const int t_move = transform_move(move, sym);
+            const int candidate = evaluate_move(&transformed, t_move % BOARD_SIZE, t_move / BOARD_SIZE, player);
+            if (candidate != reference) {
+                describe(detail, "evaluate_move(%d, %c) %d, symmetry %d (move %d) gives %d",
+                         move, player, reference, sym, t_move, candidate);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// generated moves are legal, scored by evaluate_move, sorted and within the 1/90 cut of the best move
+static bool check_find_next_moves(const Board* board, const char player, char* detail) {
+    if (is_board_empty(board)) return true;
+    const int count = find_next_moves(ply.moves, ply.scores, board, player, 0, -1);
+    const int available = count_next_moves(board);
+    if (count < 0 || count > available || (available > 0 && count == 0)) {
+        describe(detail, "find_next_moves returned %d of %d moves", count, available);
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        const int move = ply.moves[i];
+        if (move < 0 || move >= BOARD_SIZE*BOARD_SIZE || !is_next_position(board, move % BOARD_SIZE, move / BOARD_SIZE)) {
+            describe(detail, "find_next_moves returned illegal move %d at %d", move, i);
+            return false;
+        }
+        const int score = evaluate_move(board, move % BOARD_SIZE, move / BOARD_SIZE, player);
+        if (ply.scores[move] != score || (i > 0 && score > ply.scores[ply.moves[i-1]]) || score < ply.scores[ply.moves[0]]/90) {
+            describe(detail, "find_next_moves move %d at %d has score %d (evaluate_move %d, previous %d, best %d)",
+                     move, i, ply.scores[move], score, i > 0 ? ply.scores[ply.moves[i-1]] : 0, ply.scores[ply.moves[0]]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// the explicit stack search visits the same nodes as the recursive minimax (the reference)
+static bool check_iterative_search(const Board* board, const char player, char* detail) {
+    if (is_board_empty(board)) return true; // the first move is random
+    int scores[2], moves[2];
+    SearchStats stats[2];
+    for (int i = 0; i < 2; i++) {
+        clear_bot();
+        set_iterative_search(i == 1);
+        moves[i] = bot_search(board, player, SEARCH_CHECK_DEPTH, 0, &scores[i]);
+        stats[i] = search_stats;
+    }
+    if (moves[0] == moves[1] && scores[0] == scores[1] && stats[0].nodes == stats[1].nodes &&
+        stats[0].t_t_stores == stats[1].t_t_stores && stats[0].cutoffs == stats[1].cutoffs) return true;
+    describe(detail, "explicit stack search move %d score %d nodes %lu stores %lu cutoffs %lu, "
+             "minimax move %d score %d nodes %lu stores %lu cutoffs %lu", moves[1], scores[1],
+             (unsigned long)stats[1].nodes, (unsigned long)stats[1].t_t_stores, (unsigned long)stats[1].cutoffs,
+             moves[0], scores[0], (unsigned long)stats[0].nodes, (unsigned long)stats[0].t_t_stores,
+             (unsigned long)stats[0].cutoffs);
+    return false;
+}
+
+static const Check checks[] = {
+    {"evaluate_board", check_evaluate_board},
+    {"check_winner", check_check_winner},
+    {"count_next_moves", check_count_next_moves},
+    {"evaluation_symmetry", check_evaluation_symmetry},
+    {"evaluate_move", check_evaluate_move},
+    {"find_next_moves", check_find_next_moves},
+    {"iterative_search", check_iterative_search, true},
+};
+#define N_OF_CHECKS_RUN (int)(sizeof(checks) / sizeof(checks[0]))
+
+// position generators
+
+// n random pieces, alternating colours (can contain wins for both players)
+static void random_position(Board* board, char* player) {
+    const int n = random32() % 61;
+    *board = (Board){0};
+    for (int i = 0; i < n; i++) {
+        int move;
+        do {
+            move = random32() % (BOARD_SIZE*BOARD_SIZE);
+        } while (!place_piece(board, move % BOARD_SIZE, move / BOARD_SIZE, i % 2 ? BLACK : WHITE));
+    }
+    *player = n % 2 ? BLACK : WHITE;
+}
+
+// positions of a fast self-play game: one of the three best ordered moves, until the game ends
+static Board game_board;
+static char game_player;
+static bool game_over = true;
+
+static void self_play_position(Board* board, char* player) {
+    if (game_over) {
+        game_board = (Board){0};
+        game_player = WHITE;
+        game_over = false;
+    }
+    *board = game_board;
+    *player = game_player;
+    int count = find_next_moves(ply.moves, ply.scores, &game_board, game_player, 0, -1);
+    if (count == 0) {
+        game_over = true;
+        return;
+    }
+    count = count < 3 ? count : 3;
+    const int move = ply.moves[random32() % count];
+    place_piece(&game_board, move % BOARD_SIZE, move / BOARD_SIZE, game_player);
+    game_player = game_player == WHITE ? BLACK : WHITE;
+    if (check_winner(&game_board) != '\0') game_over = true;
+}
+
+static void format_board(const Board* board, char* out) {
+    for (int i = 0; i < BOARD_SIZE*BOARD_SIZE; i++) out[i] = get(board, i % BOARD_SIZE, i / BOARD_SIZE);
+    out[BOARD_SIZE*BOARD_SIZE] = '\0';
+}
+
+// checks n_of_positions positions, sends progress and the first mismatch to out
+static void worker(const int id, const long long n_of_positions, const uint32_t seed, const char* filter, const int out) {
+    seed_random(seed); // zobrist keys are the same in every worker
+    init_bot(SEARCH_CHECK_T_T_CAP);
+    seed_random(seed ^ (uint32_t)(id + 1) * 2654435761u);
+    WorkerReport report = {0};
+    for (long long i = 0; i < n_of_positions; i++) {
+        Board board;
+        char player;
+        const bool self_play = i & 1;
+        if (self_play) self_play_position(&board, &player);
+        else random_position(&board, &player);
+        for (int c = 0; c < N_OF_CHECKS_RUN; c++) {
+            if (filter != NULL && strstr(checks[c].name, filter) == NULL) continue;
+            if (checks[c].sampled && (i >> 1) % search_every != 0) continue; // a random and a self-play position
+            char detail[REPORT_LEN];
+            if (!checks[c].check(&board, player, detail)) {
+                char cells[BOARD_SIZE*BOARD_SIZE + 1];
+                format_board(&board, cells);
+                report.mismatch = true;
+                snprintf(report.text, REPORT_LEN, "%s mismatch on a %s position (worker %d, position %lld)\n"
+                         "  %s\n  gomoku_cli -p %c -b %s\n", checks[c].name, self_play ? "self-play" : "random",
+                         id, i, detail, player, cells);
+                break;
+            }
+        }
+        report.checked++;
+        if (report.mismatch || report.checked == BATCH) {
+            if (write(out, &report, sizeof(report)) != sizeof(report)) break;
+            report.checked = 0;
+            if (report.mismatch) break;
+        }
+    }
+    report.done = true;
+    if (write(out, &report, sizeof(report)) != sizeof(report)) {}
+    free_bot();
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -n count    positions to check (default 1000000), half random and half from self-play\n"
+        "  -k name     only run checks whose name contains name\n"
+        "  -j workers  parallel workers (default: number of cores)\n"
+        "  -s seed     random seed (default 1)\n"
+        "  -S every    run the search check on 1 position in every (default %d, 1 for all)\n"
+        "checks:",
+        name, SEARCH_CHECK_EVERY);
+    for (int c = 0; c < N_OF_CHECKS_RUN; c++) fprintf(stderr, " %s", checks[c].name);
+    fprintf(stderr, "\n");
+}
+
+int main(const int argc, char** argv) {
+    long long n_of_positions = 1000000;
+    int n_of_workers = (int)sysconf(_SC_NPROCESSORS_ONLN), opt;
+    uint32_t seed = 1;
+    const char* filter = NULL;
+    while ((opt = getopt(argc, argv, "n:k:j:s:S:h")) != -1) {
+        switch (opt) {
+            case 'n': n_of_positions = atoll(optarg); break;
+            case 'k': filter = optarg; break;
+            case 'j': n_of_workers = atoi(optarg); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            case 'S': search_every = atoll(optarg); break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (n_of_positions < 1 || n_of_workers < 1 || search_every < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (n_of_workers > MAX_WORKERS) n_of_workers = MAX_WORKERS;
+    fflush(stdout);
+
+    // the engine uses globals (evaluation bit boards, caches), so workers are processes instead of threads
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t pids[MAX_WORKERS];
+    struct pollfd fds[MAX_WORKERS];
+    for (int w = 0; w < n_of_workers; w++) {
+        int fd[2];
+        if (pipe(fd) != 0) {
+            perror("pipe");
+            return 1;
+        }
+        pids[w] = fork();
+        if (pids[w] < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pids[w] == 0) {
+            close(fd[0]);
+            worker(w, n_of_positions / n_of_workers + (w < n_of_positions % n_of_workers), seed, filter, fd[1]);
+            close(fd[1]);
+            _exit(0);
+        }
+        close(fd[1]);
+        fds[w] = (struct pollfd){.fd = fd[0], .events = POLLIN};
+    }
+
+    long long checked = 0;
+    int open_workers = n_of_workers;
+    bool mismatch = false;
+    static WorkerReport report;
+    while (open_workers > 0 && !mismatch) {
+        if (poll(fds, n_of_workers, -1) < 0) break;
+        for (int w = 0; w < n_of_workers && !mismatch; w++) {
+            if (fds[w].fd < 0 || fds[w].revents == 0) continue;
+            if (read(fds[w].fd, &report, sizeof(report)) != sizeof(report)) {
+                close(fds[w].fd);
+                fds[w].fd = -1;
+                open_workers--;
+                continue;
+            }
+            checked += report.checked;
+            if (report.done) {
+                close(fds[w].fd);
+                fds[w].fd = -1;
+                open_workers--;
+                continue;
+            }
+            if (report.mismatch) {
+                mismatch = true;
+                printf("%s", report.text);
+            }
+        }
+    }
+    for (int w = 0; w < n_of_workers; w++) {
+        kill(pids[w], SIGTERM);
+        waitpid(pids[w], NULL, 0);
+        if (fds[w].fd >= 0) close(fds[w].fd);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    const double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%lld positions checked in %.1f s (%.0f positions/min), %s\n", checked, seconds,
+           seconds > 0 ? checked / seconds * 60 : 0, mismatch ? "MISMATCH" : "no mismatches");
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+//
+// fake_radio.c
+// Developed by the GAME2 Team.
+// Fake PIC behind the game core's radio send function, see fake_radio.h.
+//
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "fake_radio.h"
+#include "game.h"
+
+static pthread_mutex_t pic_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int loss = 0;
+static unsigned int random_state = 1;
+static uint8_t pic_safety = 0, pic_last_seq = 0; // the PIC's status
+static uint32_t n_of_sent = 0, n_of_lost = 0;
+
+void fake_radio_init(const int loss_percent, const uint32_t seed) {
+    pthread_mutex_lock(&pic_mutex);
+    loss = loss_percent;
+    random_state = seed;
+    pic_safety = pic_last_seq = 0;
+    n_of_sent = n_of_lost = 0;
+    pthread_mutex_unlock(&pic_mutex);
+}
+
+bool fake_radio_send(const nrf_message_t* message) {
+    pthread_mutex_lock(&pic_mutex);
+    n_of_sent++;
+    const bool delivered = rand_r(&random_state) % 100 >= loss;
+    if (!delivered) n_of_lost++;
+    else if (message->type == NRF_MSG_MOVE) pic_last_seq = message->seq;
+    const nrf_message_t status = {.type = NRF_MSG_STATUS, .length = 2, .data = {pic_safety, pic_last_seq}};
+    pthread_mutex_unlock(&pic_mutex);
+
+    game_radio_delivered(message, delivered);
+    if (delivered) game_pic_message(&status); // ACK payload
+    return true;
+}
+
+void fake_radio_safety(const uint8_t state) {
+    pthread_mutex_lock(&pic_mutex);
+    pic_safety = state;
+    pthread_mutex_unlock(&pic_mutex);
+    const nrf_message_t message = {.type = NRF_MSG_SAFETY, .length = 1, .data = {state}};
+    game_pic_message(&message);
+}
+
+void fake_radio_counts(uint32_t* sent, uint32_t* lost) {
+    pthread_mutex_lock(&pic_mutex);
+    *sent = n_of_sent;
+    *lost = n_of_lost;
+    pthread_mutex_unlock(&pic_mutex);
+}
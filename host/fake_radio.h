@@ -0,0 +1,27 @@
+//
+// fake_radio.h
+// Developed by the GAME2 Team.
+// Fake PIC behind the game core's radio send function, in place of the nRF24: a move is delivered at once
+// (or lost with the given probability) and answered with the status the PIC returns in its ACK payload.
+//
+
+#ifndef FAKE_RADIO_H
+#define FAKE_RADIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nrf_frame.h"
+
+void fake_radio_init(int loss_percent, uint32_t seed);
+
+// game_radio_send_t, reports the delivery and the status from the calling task
+bool fake_radio_send(const nrf_message_t* message);
+
+// the PIC's safety system interrupt
+void fake_radio_safety(uint8_t state);
+
+// messages sent and lost since fake_radio_init
+void fake_radio_counts(uint32_t* sent, uint32_t* lost);
+
+#endif //FAKE_RADIO_H
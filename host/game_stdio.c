@@ -0,0 +1,73 @@
+//
+// game_stdio.c
+// Developed by the GAME2 Team.
+// The device's game core on the host: line protocol commands (main/src/game_line.h) from stdin, answers and
+// events on stdout, the log on stderr. The PIC is fake_radio.c, "pic safety <state>" trips its safety system.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bot.h"
+#include "fake_radio.h"
+#include "game.h"
+#include "game_line.h"
+#include "zobrist.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// called from the main thread and the search task, a line is written at once
+static void write_stdout(const char* line) {
+    flockfile(stdout);
+    fputs(line, stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+    funlockfile(stdout);
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "usage: %s [options] < commands\n"
+        "  -T entries  transposition table capacity (default 15000)\n"
+        "  -l percent  moves lost by the fake radio (default 0)\n"
+        "  -s seed     random seed (default 1)\n"
+        "  commands: see main/src/game_line.h, plus \"pic safety <state>\"\n",
+        name);
+}
+
+int main(const int argc, char** argv) {
+    int t_t_cap = 15000, loss = 0, opt;
+    uint32_t seed = 1;
+    while ((opt = getopt(argc, argv, "T:l:s:h")) != -1) {
+        switch (opt) {
+            case 'T': t_t_cap = atoi(optarg); break;
+            case 'l': loss = atoi(optarg); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind != argc || t_t_cap < 1 || loss < 0 || loss > 100) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    seed_random(seed);
+    init_bot(t_t_cap);
+    fake_radio_init(loss, seed);
+    if (!game_init(fake_radio_send)) {
+        fprintf(stderr, "failed to start the search task\n");
+        return 1;
+    }
+    game_line_init(write_stdout);
+
+    char line[GAME_LINE_MAX];
+    unsigned int state;
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        if (sscanf(line, " pic safety %u", &state) == 1) fake_radio_safety(state);
+        else game_line_handle(line);
+    }
+    while (game_busy()) vTaskDelay(pdMS_TO_TICKS(10)); // answers of the last commands
+    free_bot();
+    return 0;
+}
@@ -0,0 +1,155 @@
+//
+// loadtest.c
+// Developed by the GAME2 Team.
+// Load test of the game core through the loopback front end: a client plays random O moves back to back
+// against the bot (fake_radio.c as the PIC) and reports the turn latency, from the move request to its reply.
+//
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "bot.h"
+#include "fake_radio.h"
+#include "game.h"
+#include "game_loopback.h"
+#include "zobrist.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    const double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// nearest rank percentile of sorted values
+static double percentile(const double* sorted, const int n, const double p) {
+    const int rank = (int)ceil(p * n);
+    return sorted[rank < 1 ? 0 : rank - 1];
+}
+
+// waits for the reply of seq, returns false on timeout
+static bool wait_reply(const uint8_t seq, const uint32_t timeout_ms, uint8_t reply[3]) {
+    GameEvent event;
+    while (game_loopback_wait(&event, timeout_ms)) {
+        if (event.type == GAME_EVENT_MOVE_REPLY && event.data[0] == seq) {
+            memcpy(reply, event.data, 3);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -g games    games to play (default 20)\n"
+        "  -d depth    bot search depth (default 3, max %d)\n"
+        "  -T entries  transposition table capacity (default 15000)\n"
+        "  -l percent  moves lost by the fake radio (default 0)\n"
+        "  -t ms       reply timeout (default 60000)\n"
+        "  -s seed     random seed (default 1)\n"
+        "  -f          fill the search queue before every reset, the first move of a game then finds it full\n",
+        name, GAME_MAX_DEPTH);
+}
+
+int main(const int argc, char** argv) {
+    int n_of_games = 20, depth = 3, t_t_cap = 15000, loss = 0, timeout_ms = 60000, opt;
+    bool fill = false;
+    uint32_t seed = 1;
+    while ((opt = getopt(argc, argv, "g:d:T:l:t:s:fh")) != -1) {
+        switch (opt) {
+            case 'g': n_of_games = atoi(optarg); break;
+            case 'd': depth = atoi(optarg); break;
+            case 'T': t_t_cap = atoi(optarg); break;
+            case 'l': loss = atoi(optarg); break;
+            case 't': timeout_ms = atoi(optarg); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            case 'f': fill = true; break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind != argc || n_of_games < 1 || depth < 1 || depth > GAME_MAX_DEPTH || t_t_cap < 1 || loss < 0 ||
+        loss > 100 || timeout_ms < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    seed_random(seed);
+    init_bot(t_t_cap);
+    fake_radio_init(loss, seed);
+    if (!game_init(fake_radio_send) || !game_loopback_init()) {
+        fprintf(stderr, "failed to start the game core\n");
+        return 1;
+    }
+    game_set_depth(depth);
+
+    unsigned int random_state = seed;
+    const int max_turns = n_of_games * BOARD_SIZE*BOARD_SIZE / 2;
+    double* latencies = malloc(max_turns * sizeof(double));
+    int n_of_turns = 0, wins_o = 0, wins_x = 0, draws = 0, n_of_full = 0;
+    uint8_t seq = 0;
+    const double start = now();
+    for (int g = 0; g < n_of_games; g++) {
+        bool occupied[BOARD_SIZE*BOARD_SIZE] = {false};
+        int n_of_empty = BOARD_SIZE*BOARD_SIZE;
+        if (fill) while (game_submit_autoplay(BLACK) == GAME_OK) {} // dropped by the reset, once dequeued
+        game_reset();
+        for (;;) {
+            // random empty cell for O
+            int cell, skip = rand_r(&random_state) % n_of_empty;
+            for (cell = 0; occupied[cell] || skip-- > 0; cell++) {}
+            occupied[cell] = true;
+            n_of_empty--;
+
+            seq++;
+            const double sent = now();
+            GameResult result;
+            while ((result = game_submit_move(seq, cell)) == GAME_FULL) { // retried with the same seq
+                n_of_full++;
+                vTaskDelay(1);
+            }
+            uint8_t reply[3];
+            if (result != GAME_OK || !wait_reply(seq, timeout_ms, reply) || reply[2] == GAME_MOVE_REJECTED) {
+                fprintf(stderr, "game %d: move %d (seq %d) not played\n", g, cell, seq);
+                free(latencies);
+                return 1;
+            }
+            latencies[n_of_turns++] = (now() - sent) * 1000;
+
+            if (reply[1] != GAME_MOVE_NONE) {
+                occupied[reply[1]] = true;
+                n_of_empty--;
+            }
+            if (reply[2] == WHITE) wins_o++;
+            else if (reply[2] == BLACK) wins_x++;
+            else if (reply[2] == EMPTY) draws++;
+            if (reply[2] != 0) break;
+        }
+    }
+    const double seconds = now() - start;
+
+    uint32_t sent, lost;
+    fake_radio_counts(&sent, &lost);
+    qsort(latencies, n_of_turns, sizeof(double), compare_doubles);
+    double sum = 0;
+    for (int i = 0; i < n_of_turns; i++) sum += latencies[i];
+    printf("games %d (X %d, O %d, draws %d), turns %d in %.2f s, depth %d\n", n_of_games, wins_x, wins_o, draws,
+           n_of_turns, seconds, depth);
+    printf("radio: %u moves sent, %u lost; %d move requests found the search queue full\n", sent, lost, n_of_full);
+    printf("turn latency ms: mean %.2f p50 %.2f p90 %.2f p99 %.2f max %.2f\n", sum / n_of_turns,
+           percentile(latencies, n_of_turns, 0.5), percentile(latencies, n_of_turns, 0.9),
+           percentile(latencies, n_of_turns, 0.99), latencies[n_of_turns - 1]);
+    free(latencies);
+    free_bot();
+    return 0;
+}
@@ -0,0 +1,234 @@
+//
+// microbench.c
+// Developed by the GAME2 Team.
+// Microbenchmarks (ns/op) for every engine kernel, so hot path rewrites can be measured in isolation.
+// Runs on host (gomoku_microbench) and on the device (CONFIG_GOMOKU_MICROBENCH, called from app_main).
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include "Board.h"
+#include "bot.h"
+#include "hashmap.h"
+#include "zobrist.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#define MIN_TIME_NS 20000000LL // the device is slow, keep every kernel to ~20 ms
+#else
+#include <time.h>
+#define MIN_TIME_NS 100000000LL
+#endif
+
+#define N_OF_BOARDS 64 // boards cycled through by the kernels (power of 2)
+#define MAP_CAP 15000  // entries of the benchmarked maps (the bot's table), less when the device heap is short
+
+static long long now_ns() {
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time() * 1000LL;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+#endif
+}
+
+typedef void (*kernel_fn)(int i);
+
+static Board boards[N_OF_BOARDS];
+static Board other_boards[N_OF_BOARDS]; // never stored in the maps (misses)
+static Map map;
+static SharedMap shared_map;
+static Direction kernel_dir;
+static const char* kernel_sequence;
+static SearchPly ply;
+static volatile int sink; // keeps results alive so the kernels aren't optimised away
+static const char* filter = NULL;
+
+// places n random pieces (alternating colours) on a board without a winner
+static void random_board(Board* board, const int n) {
+    do {
+        *board = (Board){0};
+        for (int i = 0; i < n; i++) {
+            int move;
+            do {
+                move = random32() % (BOARD_SIZE*BOARD_SIZE);
+            } while (!place_piece(board, move % BOARD_SIZE, move / BOARD_SIZE, i % 2 ? BLACK : WHITE));
+        }
+    } while (check_winner(board) != '\0');
+}
+
+// times a kernel until it ran at least MIN_TIME_NS and prints ns per call
+static void bench(const char* name, const kernel_fn kernel) {
+    if (filter != NULL && strstr(name, filter) == NULL) return;
+    for (int i = 0; i < N_OF_BOARDS; i++) kernel(i); // warm up
+    long long iterations = 256, elapsed;
+    for (;;) {
+        const long long start = now_ns();
+        for (long long i = 0; i < iterations; i++) kernel((int)i);
+        elapsed = now_ns() - start;
+        if (elapsed >= MIN_TIME_NS) break;
+        iterations *= elapsed < MIN_TIME_NS / 16 ? 8 : 2;
+    }
+    printf("%-36s %12.1f ns/op\n", name, (double)elapsed / (double)iterations);
+}
+
+// kernels (i selects the board)
+static void k_shift_and(const int i) {
+    uint16_t bb[BOARD_SIZE];
+    memcpy(bb, boards[i & (N_OF_BOARDS-1)].white, sizeof(bb));
+    shift_and(&boards[i & (N_OF_BOARDS-1)], bb, WHITE, kernel_dir, 1);
+    sink = bb[5];
+}
+static void k_count_sequence(const int i) { // 2-sequence bit boards are prepared for boards[20] only
+    sink = count_sequence(&boards[20], kernel_sequence, kernel_dir) + i;
+}
+static void k_count_direction(const int i) {
+    int white[N_OF_CHECKS] = {0}, black[N_OF_CHECKS] = {0};
+    init_eval(&boards[i & (N_OF_BOARDS-1)]);
+    count_direction(&boards[i & (N_OF_BOARDS-1)], kernel_dir, white, black);
+    sink = white[0] + black[0];
+}
+static void k_static_evaluation(const int i) { sink = static_evaluation(&boards[i & (N_OF_BOARDS-1)]); }
+static void k_evaluate_board(const int i) { sink = evaluate_board(&boards[i & (N_OF_BOARDS-1)]); }
+static void k_evaluate_move(const int i) {
+    const Board* board = &boards[i & (N_OF_BOARDS-1)];
+    const int move = (i * 37) % (BOARD_SIZE*BOARD_SIZE);
+    sink = evaluate_move(board, move % BOARD_SIZE, move / BOARD_SIZE, i & 1 ? BLACK : WHITE);
+}
+static void k_count_next_moves(const int i) { sink = count_next_moves(&boards[i & (N_OF_BOARDS-1)]); }
+static void k_find_next_moves(const int i) {
+    sink = find_next_moves(ply.moves, ply.scores, &boards[i & (N_OF_BOARDS-1)], i & 1 ? BLACK : WHITE, 0, -1);
+}
+static void k_check_winner(const int i) { sink = check_winner(&boards[i & (N_OF_BOARDS-1)]); }
+static void k_zobrist(const int i) { sink = (int)hash_board(&boards[i & (N_OF_BOARDS-1)]); }
+static void k_canonical_zobrist(const int i) {
+    int sym;
+    sink = (int)canonical_hash_board(&boards[i & (N_OF_BOARDS-1)], &sym);
+}
+static void k_get_map_hit(const int i) { sink = get_map(&map, &boards[i & (N_OF_BOARDS-1)]) != NULL; }
+static void k_get_map_miss(const int i) { sink = get_map(&map, &other_boards[i & (N_OF_BOARDS-1)]) != NULL; }
+static void k_put_map_update(const int i) { put_map(&map, &boards[i & (N_OF_BOARDS-1)], i, 1, -1, false); }
+static void k_get_shared_hit(const int i) {
+    data entry;
+    sink = get_shared_map(&shared_map, &boards[i & (N_OF_BOARDS-1)], &entry);
+}
+static void k_get_shared_miss(const int i) {
+    data entry;
+    sink = get_shared_map(&shared_map, &other_boards[i & (N_OF_BOARDS-1)], &entry);
+}
+static void k_put_shared_update(const int i) { put_shared_map(&shared_map, &boards[i & (N_OF_BOARDS-1)], i, 1, -1, false); }
+
+// capacity of the benchmarked maps: the Map and the SharedMap are allocated side by side
+static int bench_map_cap() {
+#ifdef ESP_PLATFORM
+    const size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT); // no PSRAM on the S3 board
+    return MIN(MAP_CAP, (int)(largest / 2 / MAX(sizeof(data), sizeof(shared_entry))));
+#else
+    return MAP_CAP;
+#endif
+}
+
+// fills the maps to a fraction of their capacity, the benchmark boards included.
+// Returns false when they can't be allocated
+static bool fill_maps(const int cap, const int percent) {
+    free_map(&map);
+    free_shared_map(&shared_map);
+    map = init_map(cap);
+    shared_map = init_shared_map(cap);
+    if (map.buckets == NULL || shared_map.buckets == NULL) return false;
+    for (int i = 0; i < N_OF_BOARDS; i++) {
+        put_map(&map, &boards[i], i, 1, -1, false);
+        put_shared_map(&shared_map, &boards[i], i, 1, -1, false);
+    }
+    Board board;
+    while (map.size < (long long)cap * percent / 100) {
+        random_board(&board, 6 + random32() % 30);
+        put_map(&map, &board, 0, 0, -1, false);
+        put_shared_map(&shared_map, &board, 0, 0, -1, false);
+    }
+    return true;
+}
+
+// runs every microbenchmark whose name contains name_filter (NULL = all)
+void run_microbenchmarks(const char* name_filter) {
+    static const char* direction_names[4] = {"horizontal", "vertical", "diagonal_forward", "diagonal_back"};
+    static const char* sequences[] = {"OOOOO", "XXXXX", "AA---", "-AA--", "AA-AA", "-AA-O", "-AA-O-", "AAO", "AAO--", "AAAA-", "-AAO-", "-AAAA-", "AAO-O"};
+    static const int fill_levels[] = {25, 50, 90};
+    char name[64];
+    filter = name_filter;
+
+    seed_random(1);
+    init_bot(15000);
+    for (int i = 0; i < N_OF_BOARDS; i++) {
+        random_board(&boards[i], 4 + i % 32);
+        random_board(&other_boards[i], 4 + i % 32);
+    }
+
+    for (int dir = 0; dir < 4; dir++) {
+        kernel_dir = dir;
+        snprintf(name, sizeof(name), "shift_and/%s", direction_names[dir]);
+        bench(name, k_shift_and);
+    }
+    kernel_dir = HORIZONTAL;
+    for (int s = 0; s < (int)(sizeof(sequences) / sizeof(sequences[0])); s++) {
+        kernel_sequence = sequences[s];
+        int white[N_OF_CHECKS] = {0}, black[N_OF_CHECKS] = {0};
+        init_eval(&boards[20]);
+        count_direction(&boards[20], kernel_dir, white, black);
+        snprintf(name, sizeof(name), "count_sequence/%s", sequences[s]);
+        bench(name, k_count_sequence);
+    }
+    for (int dir = 0; dir < 4; dir++) {
+        kernel_dir = dir;
+        snprintf(name, sizeof(name), "count_direction/%s", direction_names[dir]);
+        bench(name, k_count_direction);
+    }
+    bench("static_evaluation", k_static_evaluation);
+    bench("evaluate_board (cached)", k_evaluate_board);
+    bench("evaluate_move", k_evaluate_move);
+    bench("count_next_moves", k_count_next_moves);
+    bench("find_next_moves", k_find_next_moves);
+    bench("check_winner", k_check_winner);
+    bench("zobrist", k_zobrist);
+    bench("zobrist/canonical", k_canonical_zobrist);
+
+    free_bot(); // the maps below take the place of its transposition table
+    const int cap = bench_map_cap();
+    map = init_map(1);
+    shared_map = init_shared_map(1);
+    for (int f = 0; f < (int)(sizeof(fill_levels) / sizeof(fill_levels[0])); f++) {
+        if (!fill_maps(cap, fill_levels[f])) {
+            printf("map benchmarks skipped: no memory for 2 maps of %d entries\n", cap);
+            break;
+        }
+        snprintf(name, sizeof(name), "get_map/hit/%d%%", fill_levels[f]);
+        bench(name, k_get_map_hit);
+        snprintf(name, sizeof(name), "get_map/miss/%d%%", fill_levels[f]);
+        bench(name, k_get_map_miss);
+        snprintf(name, sizeof(name), "put_map/update/%d%%", fill_levels[f]);
+        bench(name, k_put_map_update);
+        snprintf(name, sizeof(name), "get_shared_map/hit/%d%%", fill_levels[f]);
+        bench(name, k_get_shared_hit);
+        snprintf(name, sizeof(name), "get_shared_map/miss/%d%%", fill_levels[f]);
+        bench(name, k_get_shared_miss);
+        snprintf(name, sizeof(name), "put_shared_map/update/%d%%", fill_levels[f]);
+        bench(name, k_put_shared_update);
+    }
+    free_map(&map);
+    free_shared_map(&shared_map);
+}
+
+#ifndef ESP_PLATFORM
+int main(const int argc, char** argv) {
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "usage: %s [name filter]\n", argv[0]);
+        return 2;
+    }
+    run_microbenchmarks(argc == 2 ? argv[1] : NULL);
+    return 0;
+}
+#endif
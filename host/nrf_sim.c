@@ -0,0 +1,521 @@
+//
+// nrf_sim.c
+// Developed by the GAME2 Team.
+// Register level nRF24L01 simulator and simulated PIC, see nrf_sim.h. Timing follows the datasheet:
+// 130 us settling before every packet, 1 byte preamble, 5 byte address, 9 bit packet control field,
+// payload and CRC at the RF_SETUP data rate, ARD between retransmits and ARC retransmits before MAX_RT.
+//
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <time.h>
+
+#include "nrf_sim.h"
+#include "nrf_frame.h"
+#include "spi_nrf.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+
+// registers spi_nrf.h doesn't name
+#define REG_EN_RXADDR    0x02
+#define REG_SETUP_AW     0x03
+#define REG_SETUP_RETR   0x04
+#define REG_OBSERVE_TX   0x08
+#define REG_RPD          0x09
+#define REG_RX_ADDR_P1   0x0B
+#define N_OF_REGISTERS   0x1E
+#define ADDRESS_WIDTH    5
+
+#define CONFIG_IRQ_MASKS 0x70 // MASK_RX_DR, MASK_TX_DS, MASK_MAX_RT
+#define CONFIG_EN_CRC    (1 << 3)
+#define CONFIG_CRCO      (1 << 2)
+#define CONFIG_PWR_UP    (1 << 1)
+#define CONFIG_PRIM_RX   (1 << 0)
+#define STATUS_RX_DR     (1 << 6)
+#define STATUS_TX_DS     (1 << 5)
+#define STATUS_MAX_RT    (1 << 4)
+#define STATUS_IRQS      (STATUS_RX_DR | STATUS_TX_DS | STATUS_MAX_RT)
+#define STATUS_RX_EMPTY  (7 << 1) // RX_P_NO
+#define STATUS_TX_FULL   (1 << 0)
+#define FIFO_TX_FULL     (1 << 5)
+#define FIFO_TX_EMPTY    (1 << 4)
+#define FIFO_RX_FULL     (1 << 1)
+#define FIFO_RX_EMPTY    (1 << 0)
+#define FEATURE_EN_DPL   (1 << 2)
+#define FEATURE_EN_ACK_PAY (1 << 1)
+#define FEATURE_EN_DYN_ACK (1 << 0)
+#define RF_DR_LOW        (1 << 5)
+#define RF_DR_HIGH       (1 << 3)
+
+#define CMD_W_TX_PAYLOAD_NO_ACK 0xB0
+#define ACTIVATE_FEATURES 0x73
+
+#define FIFO_LEVELS      3
+#define SETTLING_US      130  // PLL settling before every packet, ACKs included
+#define PIC_QUEUE_LEN    8    // frames the PIC has to send
+#define PIC_RETRY_US     1000 // the PIC sends again after a missing ACK
+#define PIC_MAX_TRIES    50
+
+// radio settings of the PIC, the ESP32 has to match them
+#define PIC_CHANNEL 0x10
+#define PIC_CRC     (CONFIG_EN_CRC | CONFIG_CRCO)
+static const uint8_t pic_address[ADDRESS_WIDTH] = {0x00, 0x00, 0x00, 0x00, 0x01};
+
+typedef struct Packet {
+    uint8_t data[NRF_FRAME_MAX_SIZE];
+    uint8_t length;
+    uint8_t pid;   // packet id, a retransmit keeps it
+    bool no_ack;
+} Packet;
+
+typedef struct Fifo {
+    Packet packets[FIFO_LEVELS];
+    int head, count;
+} Fifo;
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t changed; // SPI command or CE edge
+static NrfSimConfig config;
+static unsigned int random_state;
+static NrfSimStats stats;
+
+// the ESP32's chip
+static uint8_t registers[N_OF_REGISTERS][ADDRESS_WIDTH];
+static Fifo tx_fifo, rx_fifo;
+static uint8_t next_pid = 0;
+static bool features_active = false; // ACTIVATE 0x73 toggles FEATURE, DYNPD, R_RX_PL_WID and the ACK payloads
+static bool ce = false, irq_low = false;
+static uint8_t rx_last_pid = 0xFF;
+static uint16_t rx_last_crc;
+
+// the PIC
+static Packet pic_ack;        // status frame loaded as ACK payload
+static bool pic_ack_loaded = false;
+static uint8_t pic_last_pid = 0xFF;
+static uint16_t pic_last_crc;
+static nrf_rx_state_t pic_rx;      // seqs of the ESP32's messages
+static nrf_message_t pic_restart;  // heads the PIC's frames until one of its transmissions is acknowledged
+static bool pic_restart_pending = true;
+static int16_t pic_last_move_seq = -1;
+static uint8_t pic_safety = 0, pic_status_seq = 0, pic_safety_seq = 0, pic_next_pid = 0;
+static Packet pic_queue[PIC_QUEUE_LEN];
+static int pic_queue_head = 0, pic_queue_count = 0, pic_tries = 0;
+static uint64_t pic_next_try_us = 0;
+static uint8_t pic_move_seqs[NRF_SIM_PIC_MOVES], pic_move_cells[NRF_SIM_PIC_MOVES];
+static int n_of_pic_moves = 0;
+
+static uint64_t now_us() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+// the air: other threads use the chip in the meantime
+static void sleep_unlocked(const uint32_t us) {
+    pthread_mutex_unlock(&mutex);
+    const struct timespec t = {us / 1000000, (long)(us % 1000000) * 1000};
+    nanosleep(&t, NULL);
+    pthread_mutex_lock(&mutex);
+}
+
+static bool chance(const int percent) {
+    return percent > 0 && (int)(rand_r(&random_state) % 100) < percent;
+}
+
+static uint8_t reg(const uint8_t address) {
+    return registers[address][0];
+}
+
+static int register_width(const uint8_t address) {
+    return address == NRF_REG_RX_ADDR_P0 || address == REG_RX_ADDR_P1 || address == NRF_REG_TX_ADDR ? ADDRESS_WIDTH : 1;
+}
+
+static uint8_t status() {
+    return (reg(NRF_REG_STATUS) & STATUS_IRQS) | (rx_fifo.count == 0 ? STATUS_RX_EMPTY : 0) |
+           (tx_fifo.count == FIFO_LEVELS ? STATUS_TX_FULL : 0);
+}
+
+static uint8_t fifo_status() {
+    return (tx_fifo.count == FIFO_LEVELS ? FIFO_TX_FULL : 0) | (tx_fifo.count == 0 ? FIFO_TX_EMPTY : 0) |
+           (rx_fifo.count == FIFO_LEVELS ? FIFO_RX_FULL : 0) | (rx_fifo.count == 0 ? FIFO_RX_EMPTY : 0);
+}
+
+static bool dynamic_payloads() {
+    return features_active && reg(NRF_REG_FEATURE) & FEATURE_EN_DPL && reg(NRF_REG_DYNPD) & 1;
+}
+
+static bool push(Fifo* fifo, const Packet* packet) {
+    if (fifo->count == FIFO_LEVELS) return false;
+    fifo->packets[(fifo->head + fifo->count++) % FIFO_LEVELS] = *packet;
+    return true;
+}
+
+static void pop(Fifo* fifo) {
+    if (fifo->count == 0) return;
+    fifo->head = (fifo->head + 1) % FIFO_LEVELS;
+    fifo->count--;
+}
+
+// the IRQ line is low while an unmasked STATUS interrupt bit is set
+static void update_irq() {
+    const bool low = (reg(NRF_REG_STATUS) & STATUS_IRQS & ~(reg(NRF_REG_CONFIG) & CONFIG_IRQ_MASKS)) != 0;
+    if (low == irq_low) return;
+    irq_low = low;
+    if (low) stats.irqs++;
+    host_gpio_input(NRF_IRQ_PIN, !low); // falling edge: the ISR of the driver
+}
+
+static void set_status(const uint8_t bits) {
+    registers[NRF_REG_STATUS][0] |= bits;
+    update_irq();
+}
+
+// airtime of a packet (an ACK has length 0 or its payload)
+static uint32_t airtime_us(const int length) {
+    const uint8_t config_reg = reg(NRF_REG_CONFIG);
+    const int crc = config_reg & CONFIG_EN_CRC ? (config_reg & CONFIG_CRCO ? 2 : 1) : 0;
+    const int bits = 8 * (1 + ADDRESS_WIDTH + length + crc) + 9;
+    const uint8_t rate = reg(NRF_REG_RF_SETUP) & (RF_DR_LOW | RF_DR_HIGH);
+    const int kbps = rate & RF_DR_LOW ? 250 : rate & RF_DR_HIGH ? 2000 : 1000;
+    return (bits * 1000 + kbps - 1) / kbps;
+}
+
+// channel, data rate, CRC and dynamic payload length of the PIC (its pipe uses DPL)
+static bool same_link() {
+    return reg(NRF_REG_RF_CH) == PIC_CHANNEL && !(reg(NRF_REG_RF_SETUP) & (RF_DR_LOW | RF_DR_HIGH)) &&
+           (reg(NRF_REG_CONFIG) & (CONFIG_EN_CRC | CONFIG_CRCO)) == PIC_CRC && dynamic_payloads();
+}
+
+/* The PIC */
+
+// starts a frame of the PIC, with its restart message until the ESP32 has it
+static void pic_frame_init(nrf_frame_t* frame) {
+    nrf_frame_init(frame);
+    if (pic_restart_pending) nrf_frame_add(frame, &pic_restart);
+}
+
+// reloads the status ACK payload: safety state, seq of the last move played
+static void pic_load_status() {
+    nrf_frame_t frame;
+    pic_frame_init(&frame);
+    const nrf_message_t status = {.type = NRF_MSG_STATUS, .seq = ++pic_status_seq, .length = 2,
+                                  .data = {pic_safety, pic_last_move_seq < 0 ? 0 : (uint8_t)pic_last_move_seq}};
+    nrf_frame_add(&frame, &status);
+    nrf_frame_finish(&frame);
+    memcpy(pic_ack.data, frame.data, frame.length);
+    pic_ack.length = frame.length;
+    pic_ack_loaded = true;
+}
+
+// a packet reached the PIC: its chip drops retransmits of the last packet, its firmware plays a move only when
+// its seq is after the last one (a frame resent after MAX_RT repeats the moves of the first transmission). The ACK carries the payload loaded before the packet arrived, a new packet uses it up
+static void pic_receive(const Packet* packet, Packet* ack, bool* has_ack_payload) {
+    stats.pic_packets++;
+    *ack = pic_ack;
+    *has_ack_payload = pic_ack_loaded;
+    const uint16_t crc = nrf_crc16(packet->data, packet->length);
+    if (packet->pid == pic_last_pid && crc == pic_last_crc) {
+        stats.pic_duplicates++;
+        return;
+    }
+    pic_ack_loaded = false;
+    pic_last_pid = packet->pid;
+    pic_last_crc = crc;
+
+    nrf_message_t messages[NRF_FRAME_MAX_MESSAGES];
+    const int n = nrf_frame_parse(packet->data, packet->length, messages, NRF_FRAME_MAX_MESSAGES);
+    if (n < 0) {
+        stats.pic_bad_frames++;
+        return;
+    }
+    bool played = false;
+    for (int i = 0; i < n; i++) {
+        if (!nrf_rx_accept(&pic_rx, &messages[i])) {
+            stats.pic_repeated++;
+            continue;
+        }
+        if (messages[i].type != NRF_MSG_MOVE || messages[i].length < 1) continue;
+        pic_last_move_seq = messages[i].seq;
+        if (n_of_pic_moves < NRF_SIM_PIC_MOVES) {
+            pic_move_seqs[n_of_pic_moves] = messages[i].seq;
+            pic_move_cells[n_of_pic_moves] = messages[i].data[0];
+        }
+        n_of_pic_moves++;
+        played = true;
+    }
+    if (played) pic_load_status();
+}
+
+// one transmission of the PIC's first queued frame to the ESP32, which must be listening on its address
+static void pic_transmit() {
+    const Packet packet = pic_queue[pic_queue_head];
+    const uint32_t us = airtime_us(packet.length);
+    sleep_unlocked(SETTLING_US + us);
+    stats.airtime_us += us;
+    stats.pic_sent++;
+    const bool listening = (reg(NRF_REG_CONFIG) & (CONFIG_PWR_UP | CONFIG_PRIM_RX)) == (CONFIG_PWR_UP | CONFIG_PRIM_RX) && ce;
+    bool acked = false;
+    if (listening && same_link() && reg(REG_EN_RXADDR) & 1 &&
+        memcmp(registers[NRF_REG_RX_ADDR_P0], pic_address, ADDRESS_WIDTH) == 0 && !chance(config.loss_percent)) {
+        const uint16_t crc = nrf_crc16(packet.data, packet.length);
+        bool stored = true;
+        if (packet.pid != rx_last_pid || crc != rx_last_crc) { // not a retransmit
+            stored = push(&rx_fifo, &packet);                   // a full RX FIFO doesn't acknowledge
+            if (stored) {
+                rx_last_pid = packet.pid;
+                rx_last_crc = crc;
+                set_status(STATUS_RX_DR);
+            }
+        }
+        if (stored && reg(NRF_REG_EN_AA) & 1 && !chance(config.ack_loss_percent)) {
+            const uint32_t ack_us = airtime_us(0);
+            sleep_unlocked(SETTLING_US + ack_us);
+            stats.airtime_us += ack_us;
+            acked = true;
+        }
+    }
+    if (acked || ++pic_tries == PIC_MAX_TRIES) { // given up on after PIC_MAX_TRIES
+        pic_queue_head = (pic_queue_head + 1) % PIC_QUEUE_LEN;
+        pic_queue_count--;
+        pic_tries = 0;
+        if (acked) {
+            pic_restart_pending = false; // the ESP32 has the restart message at the head of the frame
+            return;
+        }
+    }
+    stats.pic_retries++;
+    pic_next_try_us = now_us() + PIC_RETRY_US;
+}
+
+/* The ESP32's chip */
+
+static bool can_transmit() {
+    return (reg(NRF_REG_CONFIG) & (CONFIG_PWR_UP | CONFIG_PRIM_RX)) == CONFIG_PWR_UP && ce && tx_fifo.count > 0 &&
+           !(reg(NRF_REG_STATUS) & STATUS_MAX_RT);
+}
+
+// sends the first TX FIFO packet with auto acknowledgement and retransmits, until TX_DS or MAX_RT
+static void transmit() {
+    const Packet packet = tx_fifo.packets[tx_fifo.head];
+    const uint8_t setup_retr = reg(REG_SETUP_RETR);
+    const int arc = setup_retr & 0x0F;
+    const uint32_t ard_us = ((setup_retr >> 4) + 1) * 250;
+    for (int attempt = 0;; attempt++) {
+        const uint32_t us = airtime_us(packet.length);
+        sleep_unlocked(SETTLING_US + us);
+        stats.packets++;
+        stats.airtime_us += us;
+        const bool auto_ack = reg(NRF_REG_EN_AA) & 1 && !packet.no_ack;
+        const bool arrived = same_link() && memcmp(registers[NRF_REG_TX_ADDR], pic_address, ADDRESS_WIDTH) == 0 &&
+                             !chance(config.loss_percent);
+        Packet ack = {0};
+        bool has_ack_payload = false;
+        if (arrived) pic_receive(&packet, &ack, &has_ack_payload);
+        else stats.packets_lost++;
+
+        // the ACK comes back on the TX address, so RX_ADDR_P0 has to be the same
+        const bool ack_heard = arrived && memcmp(registers[NRF_REG_RX_ADDR_P0], registers[NRF_REG_TX_ADDR], ADDRESS_WIDTH) == 0;
+        if (arrived && auto_ack && (!ack_heard || chance(config.ack_loss_percent))) stats.acks_lost++;
+        else if (arrived || !auto_ack) {
+            if (auto_ack) {
+                const uint32_t ack_us = airtime_us(has_ack_payload ? ack.length : 0);
+                sleep_unlocked(SETTLING_US + ack_us);
+                stats.airtime_us += ack_us;
+                if (has_ack_payload && reg(NRF_REG_FEATURE) & FEATURE_EN_ACK_PAY && dynamic_payloads() &&
+                    push(&rx_fifo, &ack)) {
+                    stats.ack_payloads++;
+                    registers[NRF_REG_STATUS][0] |= STATUS_RX_DR;
+                }
+            }
+            if (tx_fifo.count > 0) pop(&tx_fifo); // unless flushed during the packet
+            registers[REG_OBSERVE_TX][0] = (reg(REG_OBSERVE_TX) & 0xF0) | attempt;
+            set_status(STATUS_TX_DS);
+            return;
+        }
+
+        sleep_unlocked(ard_us); // waiting for the ACK
+        if (attempt == arc) {
+            stats.max_rt++;
+            const uint8_t lost = MIN((reg(REG_OBSERVE_TX) >> 4) + 1, 15);
+            registers[REG_OBSERVE_TX][0] = lost << 4 | attempt;
+            set_status(STATUS_MAX_RT); // the packet stays in the TX FIFO
+            return;
+        }
+        if (!can_transmit()) return; // flushed, CE low or powered down meanwhile
+        stats.retransmits++;
+    }
+}
+
+static void* air_task(void* param) {
+    pthread_mutex_lock(&mutex);
+    for (;;) {
+        if (can_transmit()) {
+            transmit();
+        } else if (pic_queue_count > 0 && now_us() >= pic_next_try_us) {
+            pic_transmit();
+        } else if (pic_queue_count > 0) {
+            const uint64_t until = pic_next_try_us;
+            const struct timespec t = {until / 1000000, (long)(until % 1000000) * 1000};
+            pthread_cond_timedwait(&changed, &mutex, &t);
+        } else {
+            pthread_cond_wait(&changed, &mutex);
+        }
+    }
+    return NULL;
+}
+
+static void read_register(const uint8_t address, uint8_t* out, const size_t length) {
+    if (address >= N_OF_REGISTERS || length == 0) return;
+    if (address == NRF_REG_STATUS) out[0] = status();
+    else if (address == NRF_REG_FIFO_STATUS) out[0] = fifo_status();
+    else if ((address == NRF_REG_FEATURE || address == NRF_REG_DYNPD) && !features_active) out[0] = 0;
+    else memcpy(out, registers[address], MIN(length, (size_t)register_width(address)));
+}
+
+static void write_register(const uint8_t address, const uint8_t* data, const size_t length) {
+    if (address >= N_OF_REGISTERS || length == 0) return;
+    switch (address) {
+    case NRF_REG_STATUS:
+        registers[address][0] &= ~(data[0] & STATUS_IRQS); // write 1 to clear
+        return;
+    case REG_OBSERVE_TX:
+    case REG_RPD:
+    case NRF_REG_FIFO_STATUS:
+        return; // read only
+    case NRF_REG_FEATURE:
+    case NRF_REG_DYNPD:
+        if (!features_active) return;
+        break;
+    case NRF_REG_RF_CH:
+        registers[REG_OBSERVE_TX][0] &= 0x0F; // PLOS_CNT
+        break;
+    }
+    memcpy(registers[address], data, MIN(length, (size_t)register_width(address)));
+}
+
+// an SPI transaction: STATUS is shifted out with the command byte
+static void spi_transfer(const uint8_t* tx, uint8_t* rx, const size_t length) {
+    if (length == 0) return;
+    pthread_mutex_lock(&mutex);
+    rx[0] = status();
+    const uint8_t command = tx[0];
+    const uint8_t* data = tx + 1;
+    uint8_t* out = rx + 1;
+    const size_t n = length - 1;
+    memset(out, 0, n);
+    if ((command & 0xE0) == NRF_CMD_R_REGISTER) {
+        read_register(command & 0x1F, out, n);
+    } else if ((command & 0xE0) == NRF_CMD_W_REGISTER) {
+        write_register(command & 0x1F, data, n);
+    } else if (command == NRF_CMD_R_RX_PAYLOAD) {
+        if (rx_fifo.count > 0) {
+            const Packet* packet = &rx_fifo.packets[rx_fifo.head];
+            memcpy(out, packet->data, MIN(n, (size_t)packet->length));
+            pop(&rx_fifo);
+        }
+    } else if (command == NRF_CMD_R_RX_PL_WID) {
+        if (features_active && n > 0 && rx_fifo.count > 0) out[0] = rx_fifo.packets[rx_fifo.head].length;
+    } else if (command == NRF_CMD_W_TX_PAYLOAD ||
+               (command == CMD_W_TX_PAYLOAD_NO_ACK && features_active && reg(NRF_REG_FEATURE) & FEATURE_EN_DYN_ACK)) {
+        Packet packet = {.length = MIN(n, NRF_FRAME_MAX_SIZE), .pid = next_pid++ & 3,
+                         .no_ack = command == CMD_W_TX_PAYLOAD_NO_ACK};
+        memcpy(packet.data, data, packet.length);
+        push(&tx_fifo, &packet); // ignored when full
+    } else if (command == NRF_CMD_FLUSH_TX) {
+        tx_fifo.count = 0;
+    } else if (command == NRF_CMD_FLUSH_RX) {
+        rx_fifo.count = 0;
+    } else if (command == NRF_CMD_ACTIVATE) {
+        if (n > 0 && data[0] == ACTIVATE_FEATURES) features_active = !features_active;
+    }
+    update_irq();
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&mutex);
+}
+
+static void pin_output(const gpio_num_t pin, const uint32_t level) {
+    if (pin != NRF_CE_PIN) return;
+    pthread_mutex_lock(&mutex);
+    ce = level != 0;
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&mutex);
+}
+
+void nrf_sim_init(const NrfSimConfig* sim_config) {
+    static const uint8_t defaults[N_OF_REGISTERS][ADDRESS_WIDTH] = { // datasheet reset values
+        [NRF_REG_CONFIG] = {0x08}, [NRF_REG_EN_AA] = {0x3F}, [REG_EN_RXADDR] = {0x03}, [REG_SETUP_AW] = {0x03},
+        [REG_SETUP_RETR] = {0x03}, [NRF_REG_RF_CH] = {0x02}, [NRF_REG_RF_SETUP] = {0x0F}, [NRF_REG_STATUS] = {0x0E},
+        [NRF_REG_RX_ADDR_P0] = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7}, [REG_RX_ADDR_P1] = {0xC2, 0xC2, 0xC2, 0xC2, 0xC2},
+        [0x0C] = {0xC3}, [0x0D] = {0xC4}, [0x0E] = {0xC5}, [0x0F] = {0xC6},
+        [NRF_REG_TX_ADDR] = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7}, [NRF_REG_FIFO_STATUS] = {0x11},
+    };
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&changed, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pthread_mutex_lock(&mutex);
+    config = *sim_config;
+    random_state = config.seed;
+    memcpy(registers, defaults, sizeof(registers));
+    features_active = config.features_active;
+    registers[NRF_REG_STATUS][0] = 0; // only the interrupt bits are kept, the rest comes from the FIFOs
+    nrf_rx_state_init(&pic_rx);
+    pic_restart = nrf_restart_message(rand_r(&random_state));
+    pic_load_status();
+    pthread_mutex_unlock(&mutex);
+
+    host_spi_set_device_hook(spi_transfer);
+    host_gpio_set_output_hook(pin_output);
+    pthread_t thread;
+    pthread_create(&thread, NULL, air_task, NULL);
+    pthread_detach(thread);
+}
+
+void nrf_sim_pic_safety(const uint8_t state) {
+    pthread_mutex_lock(&mutex);
+    pic_safety = state;
+    pic_load_status();
+    if (pic_queue_count < PIC_QUEUE_LEN) {
+        nrf_frame_t frame;
+        pic_frame_init(&frame);
+        const nrf_message_t message = {.type = NRF_MSG_SAFETY, .seq = ++pic_safety_seq, .length = 1, .data = {state}};
+        nrf_frame_add(&frame, &message);
+        nrf_frame_finish(&frame);
+        Packet* packet = &pic_queue[(pic_queue_head + pic_queue_count++) % PIC_QUEUE_LEN];
+        memcpy(packet->data, frame.data, frame.length);
+        packet->length = frame.length;
+        packet->pid = pic_next_pid++ & 3;
+        packet->no_ack = false;
+    }
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&mutex);
+}
+
+void nrf_sim_pic_restart() {
+    pthread_mutex_lock(&mutex);
+    nrf_rx_state_init(&pic_rx);
+    pic_restart = nrf_restart_message(rand_r(&random_state));
+    pic_restart_pending = true;
+    pic_last_move_seq = -1;
+    pic_status_seq = pic_safety_seq = 0;
+    pic_load_status(); // the radio isn't reset: it still sends the frames queued before, under the previous boot id
+    pthread_mutex_unlock(&mutex);
+}
+
+void nrf_sim_stats(NrfSimStats* sim_stats) {
+    pthread_mutex_lock(&mutex);
+    *sim_stats = stats;
+    pthread_mutex_unlock(&mutex);
+}
+
+int nrf_sim_pic_moves(uint8_t* seqs, uint8_t* cells, const int max) {
+    pthread_mutex_lock(&mutex);
+    const int n = MIN(MIN(n_of_pic_moves, NRF_SIM_PIC_MOVES), max);
+    memcpy(seqs, pic_move_seqs, n);
+    memcpy(cells, pic_move_cells, n);
+    pthread_mutex_unlock(&mutex);
+    return n;
+}
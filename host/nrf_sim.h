@@ -0,0 +1,58 @@
+//
+// nrf_sim.h
+// Developed by the GAME2 Team.
+// Register level nRF24L01 simulator behind the host SPI/GPIO shim, so spi_nrf.c runs unmodified on Linux.
+// It has the register file, the 3 level TX and RX FIFOs, the STATUS and FIFO_STATUS bits, dynamic payload
+// length and ACK payloads (after ACTIVATE), auto acknowledgement with ARD/ARC retransmits and the IRQ line.
+// Packets take their airtime at the configured data rate, in real time. The other end is a simulated PIC:
+// it applies each move once, acknowledges with its status frame, sends safety messages and can restart.
+//
+
+#ifndef NRF_SIM_H
+#define NRF_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NRF_SIM_PIC_MOVES 4096 // moves the PIC remembers, in order
+
+typedef struct NrfSimConfig {
+    int loss_percent;     // packets lost on air, both directions
+    int ack_loss_percent; // ACKs lost on air when the packet arrived
+    uint32_t seed;
+    bool features_active; // ACTIVATE was sent before: the ESP32 was reset without a power cycle of the radio
+} NrfSimConfig;
+
+typedef struct NrfSimStats {
+    uint32_t packets;         // ESP32 -> PIC transmissions, retransmits included
+    uint32_t retransmits;     // automatic retransmits (ARC)
+    uint32_t max_rt;          // MAX_RT events
+    uint32_t packets_lost;
+    uint32_t acks_lost;
+    uint32_t ack_payloads;    // ACK payloads put in the RX FIFO
+    uint32_t irqs;            // falling edges of the IRQ line
+    uint64_t airtime_us;      // both directions, ACKs included
+    uint32_t pic_packets;     // packets the PIC received (duplicates included)
+    uint32_t pic_duplicates;  // retransmits of a packet it had received, dropped by the chip (PID)
+    uint32_t pic_repeated;    // messages not after the last seq of their type, dropped by the PIC
+    uint32_t pic_bad_frames;  // CRC or length errors
+    uint32_t pic_sent;        // PIC -> ESP32 transmissions (safety messages)
+    uint32_t pic_retries;     // PIC transmissions that got no ACK
+} NrfSimStats;
+
+// attaches the simulated chip to the SPI bus, CE and IRQ pins of spi_nrf.h, before nrf_init
+void nrf_sim_init(const NrfSimConfig* config);
+
+// the PIC's safety system changes: its status ACK payload is reloaded and a safety message sent
+void nrf_sim_pic_safety(uint8_t state);
+
+// the PIC's firmware reboots: its seqs start over and it forgets those of the ESP32, its next frames start with a
+// restart message. Its radio keeps the frames it had to send
+void nrf_sim_pic_restart(void);
+
+void nrf_sim_stats(NrfSimStats* stats);
+
+// moves the PIC played, in order; returns their number (at most max)
+int nrf_sim_pic_moves(uint8_t* seqs, uint8_t* cells, int max);
+
+#endif //NRF_SIM_H
@@ -0,0 +1,201 @@
+//
+// radio_bench.c
+// Developed by the GAME2 Team.
+// Benchmark of the nRF24 driver (spi_nrf.c, unmodified) against the register level simulator (nrf_sim.c):
+// moves are queued like the game core does and the tool reports delivery latency, SPI transactions and
+// airtime per move and the retransmits, then checks that the simulated PIC played every delivered move once,
+// in order.
+//
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "nrf_sim.h"
+#include "spi_nrf.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define SEQS 256
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t done_changed = PTHREAD_COND_INITIALIZER;
+static double sent_at[SEQS]; // by seq, fewer than SEQS moves are in flight (radio queue)
+static double* latencies;
+static bool* delivered;       // by move, seqs wrap
+static int n_of_done = 0, n_of_delivered = 0;
+static uint32_t n_of_status = 0, n_of_safety = 0;
+
+static double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    const double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// nearest rank percentile of sorted values
+static double percentile(const double* sorted, const int n, const double p) {
+    const int rank = (int)ceil(p * n);
+    return sorted[rank < 1 ? 0 : rank - 1];
+}
+
+static uint8_t move_cell(const int move) {
+    return move * 7 % (BOARD_SIZE*BOARD_SIZE); // consecutive moves differ
+}
+
+// nrf_tx_callback_t, from the radio task: moves complete in the order they were queued
+static void move_done(const nrf_message_t* message, const bool ok) {
+    pthread_mutex_lock(&mutex);
+    if (ok) {
+        latencies[n_of_delivered++] = (now() - sent_at[message->seq]) * 1000;
+        delivered[n_of_done] = true;
+    }
+    n_of_done++;
+    pthread_cond_signal(&done_changed);
+    pthread_mutex_unlock(&mutex);
+}
+
+// nrf_rx_callback_t: status ACK payloads and safety messages
+static void pic_message(const nrf_message_t* message) {
+    pthread_mutex_lock(&mutex);
+    if (message->type == NRF_MSG_STATUS) n_of_status++;
+    else if (message->type == NRF_MSG_SAFETY) n_of_safety++;
+    pthread_mutex_unlock(&mutex);
+}
+
+// wakes the radio task like the ISR of main.c
+static void irq_handler(void* arg) {
+    nrf_irq_from_isr();
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -n moves    moves to send (default 1000)\n"
+        "  -i ms       interval between moves, 0 queues them back to back (default 0)\n"
+        "  -l percent  packets lost on air (default 0)\n"
+        "  -a percent  ACKs lost on air (default 0)\n"
+        "  -S trips    safety messages sent by the PIC during the run (default 0)\n"
+        "  -R          the PIC restarts before each safety message after the first one\n"
+        "  -s seed     random seed (default 1)\n"
+        "  -w          the radio kept its features from a previous run (reset of the ESP32 alone)\n"
+        "  -v          print the register check of nrf_check_configuration\n",
+        name);
+}
+
+int main(const int argc, char** argv) {
+    int n_of_moves = 1000, interval_ms = 0, loss = 0, ack_loss = 0, n_of_trips = 0, opt;
+    bool check = false, restarts = false, warm = false;
+    uint32_t seed = 1;
+    while ((opt = getopt(argc, argv, "n:i:l:a:S:s:Rwvh")) != -1) {
+        switch (opt) {
+            case 'n': n_of_moves = atoi(optarg); break;
+            case 'i': interval_ms = atoi(optarg); break;
+            case 'l': loss = atoi(optarg); break;
+            case 'a': ack_loss = atoi(optarg); break;
+            case 'S': n_of_trips = atoi(optarg); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            case 'R': restarts = true; break;
+            case 'w': warm = true; break;
+            case 'v': check = true; break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind != argc || n_of_moves < 1 || n_of_moves > NRF_SIM_PIC_MOVES || interval_ms < 0 || loss < 0 ||
+        loss > 100 || ack_loss < 0 || ack_loss > 100 || n_of_trips < 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    latencies = malloc(n_of_moves * sizeof(double));
+    delivered = calloc(n_of_moves, sizeof(bool));
+    const NrfSimConfig config = {.loss_percent = loss, .ack_loss_percent = ack_loss, .seed = seed,
+                                 .features_active = warm};
+    nrf_sim_init(&config);
+    nrf_init();
+    gpio_config(&(gpio_config_t){.pin_bit_mask = 1ULL << NRF_IRQ_PIN, .mode = GPIO_MODE_INPUT,
+                                 .intr_type = GPIO_INTR_NEGEDGE});
+    gpio_install_isr_service(0);
+    gpio_isr_handler_add(NRF_IRQ_PIN, irq_handler, NULL);
+    nrf_set_tx_callback(move_done);
+    nrf_set_rx_callback(pic_message);
+    if (check) nrf_check_configuration();
+
+    // the first safety message reaches an idle radio, which has to be listening
+    int n_of_tripped = 0;
+    if (n_of_trips > 0) {
+        nrf_sim_pic_safety(++n_of_tripped % 2);
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    const double start = now();
+    for (int move = 0; move < n_of_moves; move++) {
+        if (n_of_tripped < n_of_trips && move >= (int64_t)n_of_moves * n_of_tripped / n_of_trips) {
+            if (restarts) nrf_sim_pic_restart(); // its safety seqs start over
+            nrf_sim_pic_safety(++n_of_tripped % 2);
+        }
+        const nrf_message_t message = {.type = NRF_MSG_MOVE, .seq = move % SEQS, .length = 1, .data = {move_cell(move)}};
+        pthread_mutex_lock(&mutex);
+        sent_at[message.seq] = now();
+        pthread_mutex_unlock(&mutex);
+        while (!nrf_send_message(&message)) vTaskDelay(1); // queue full
+        if (interval_ms > 0) vTaskDelay(pdMS_TO_TICKS(interval_ms));
+    }
+    pthread_mutex_lock(&mutex);
+    while (n_of_done < n_of_moves) pthread_cond_wait(&done_changed, &mutex);
+    pthread_mutex_unlock(&mutex);
+    const double seconds = now() - start;
+    vTaskDelay(pdMS_TO_TICKS(100)); // last safety messages
+
+    HostSpiCounts spi;
+    NrfSimStats air;
+    host_spi_counts(&spi);
+    nrf_sim_stats(&air);
+    static uint8_t pic_seqs[NRF_SIM_PIC_MOVES], pic_cells[NRF_SIM_PIC_MOVES];
+    const int n_of_played = nrf_sim_pic_moves(pic_seqs, pic_cells, NRF_SIM_PIC_MOVES);
+
+    // the PIC plays the queued moves in order, each once: all the delivered ones, and those whose ACKs were lost
+    int played = 0, errors = 0;
+    for (int move = 0; move < n_of_moves; move++) {
+        if (played < n_of_played && pic_seqs[played] == move % SEQS && pic_cells[played] == move_cell(move)) played++;
+        else if (delivered[move] && errors++ < 10) fprintf(stderr, "move %d (seq %d) delivered, not played\n", move, move % SEQS);
+    }
+    if (played != n_of_played) {
+        fprintf(stderr, "the PIC played %d moves that weren't sent or sent twice\n", n_of_played - played);
+        errors++;
+    }
+
+    pthread_mutex_lock(&mutex);
+    qsort(latencies, n_of_delivered, sizeof(double), compare_doubles);
+    double sum = 0;
+    for (int i = 0; i < n_of_delivered; i++) sum += latencies[i];
+    printf("moves %d: %d delivered, %d failed in %.2f s (%.0f moves/s), played by the PIC %d\n", n_of_moves,
+           n_of_delivered, n_of_moves - n_of_delivered, seconds, n_of_moves / seconds, n_of_played);
+    if (n_of_delivered > 0)
+        printf("delivery latency ms: mean %.2f p50 %.2f p90 %.2f p99 %.2f max %.2f\n", sum / n_of_delivered,
+               percentile(latencies, n_of_delivered, 0.5), percentile(latencies, n_of_delivered, 0.9),
+               percentile(latencies, n_of_delivered, 0.99), latencies[n_of_delivered - 1]);
+    printf("spi: %u transactions (%.1f per move), %u bytes, %.1f us bus time per move\n", spi.transactions,
+           (double)spi.transactions / n_of_moves, spi.bytes, spi.bus_ns / 1e3 / n_of_moves);
+    printf("air: %u packets (%.2f per move), %u retransmits, %u MAX_RT, %u lost, %u ACKs lost, airtime %.1f ms (%.1f%%)\n",
+           air.packets, (double)air.packets / n_of_moves, air.retransmits, air.max_rt, air.packets_lost, air.acks_lost,
+           air.airtime_us / 1e3, air.airtime_us / 1e4 / seconds);
+    printf("pic: %u packets, %u duplicates, %u repeated, %u bad frames; %u ACK payloads, %u IRQs\n", air.pic_packets,
+           air.pic_duplicates, air.pic_repeated, air.pic_bad_frames, air.ack_payloads, air.irqs);
+    printf("from the pic: %u status, %u/%d safety messages (%u transmissions, %u without ACK)\n", n_of_status,
+           n_of_safety, n_of_tripped, air.pic_sent, air.pic_retries);
+    pthread_mutex_unlock(&mutex);
+    free(latencies);
+    free(delivered);
+    // on a lossy link the PIC may give up on a safety message
+    return errors > 0 || (loss == 0 && ack_loss == 0 && n_of_safety != (uint32_t)n_of_tripped) ? 1 : 0;
+}
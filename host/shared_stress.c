@@ -0,0 +1,176 @@
+//
+// shared_stress.c
+// Developed by the GAME2 Team.
+// Stress test of the lockless SharedMap: writer threads keep overwriting the entries of a few boards that share
+// a small table, reader threads check that every hit is one whole entry (torn writes must read as misses),
+// and age threads start searches. All threads initialize their own map first, at the same time, and must
+// hash boards the same way.
+//
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "hashmap.h"
+
+#define MAX_THREADS 64
+#define N_OF_BOARDS 96
+#define MAP_CAP 32     // fewer buckets than boards, so writers of different keys race for the same buckets
+#define DEPTH 5        // one depth, so every put replaces the entry
+#define ID_SHIFT 20    // score: board << ID_SHIFT | version
+
+static Board boards[N_OF_BOARDS];
+static int pieces[N_OF_BOARDS];
+static SharedMap map;
+static pthread_barrier_t barrier;
+static atomic_bool stop = false;
+static atomic_llong n_of_puts, n_of_gets, n_of_hits, n_of_searches, n_of_mismatches;
+static atomic_int max_age_seen;
+static uint32_t keys[MAX_THREADS]; // hash of boards[0] seen by each thread after its init
+
+typedef struct Worker {
+    int id;
+    unsigned int seed;
+    void* (*run)(struct Worker*);
+} Worker;
+
+static int best_move_of(const int score) {
+    return (score & ((1 << ID_SHIFT) - 1)) % (BOARD_SIZE*BOARD_SIZE);
+}
+
+static void* writer(Worker* w) {
+    int version = 0;
+    while (!atomic_load(&stop)) {
+        const int board = rand_r(&w->seed) % N_OF_BOARDS;
+        const int score = board << ID_SHIFT | (version++ & ((1 << ID_SHIFT) - 1));
+        put_shared_map(&map, &boards[board], score, DEPTH, best_move_of(score), false);
+        atomic_fetch_add_explicit(&n_of_puts, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static void* reader(Worker* w) {
+    while (!atomic_load(&stop)) {
+        const int board = rand_r(&w->seed) % N_OF_BOARDS;
+        data entry;
+        atomic_fetch_add_explicit(&n_of_gets, 1, memory_order_relaxed);
+        if (!get_shared_map(&map, &boards[board], &entry)) continue;
+        atomic_fetch_add_explicit(&n_of_hits, 1, memory_order_relaxed);
+        if (entry.score >> ID_SHIFT != board || entry.best_move != best_move_of(entry.score) || entry.depth != DEPTH ||
+            entry.n_of_pieces != pieces[board] || entry.quiescence) {
+            if (atomic_fetch_add(&n_of_mismatches, 1) < 10)
+                fprintf(stderr, "board %d: hit with score 0x%08X, best move %d, depth %d, pieces %d (%d)\n", board,
+                        entry.score, entry.best_move, entry.depth, entry.n_of_pieces, pieces[board]);
+        }
+    }
+    return NULL;
+}
+
+// starts searches as fast as it can, the age must stay within its 7 bits
+static void* ager(Worker* w) {
+    while (!atomic_load(&stop)) {
+        new_search_shared_map(&map);
+        const int age = atomic_load_explicit(&map.age, memory_order_relaxed);
+        int seen = atomic_load(&max_age_seen);
+        while (age > seen && !atomic_compare_exchange_weak(&max_age_seen, &seen, age)) {}
+        atomic_fetch_add_explicit(&n_of_searches, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static void* start(void* param) {
+    Worker* w = param;
+    pthread_barrier_wait(&barrier);
+    SharedMap own = init_shared_map(SHARED_WAYS); // every thread initializes the keys at once
+    keys[w->id] = hash_board(&boards[0]);
+    free_shared_map(&own);
+    pthread_barrier_wait(&barrier); // the shared map is ready
+    pthread_barrier_wait(&barrier);
+    return w->run(w);
+}
+
+static void random_board(Board* board, unsigned int* seed, int* n_of_pieces) {
+    memset(board, 0, sizeof(Board));
+    *n_of_pieces = 1 + rand_r(seed) % 20;
+    for (int i = 0; i < *n_of_pieces; i++) {
+        int x, y;
+        do {
+            x = rand_r(seed) % BOARD_SIZE;
+            y = rand_r(seed) % BOARD_SIZE;
+        } while ((board->white[y] | board->black[y]) & 1 << (15 - x));
+        if (i % 2) board->black[y] |= 1 << (15 - x);
+        else board->white[y] |= 1 << (15 - x);
+    }
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -w writers  writer threads (default 2)\n"
+        "  -r readers  reader threads (default 2)\n"
+        "  -a agers    threads starting searches (default 2)\n"
+        "  -t ms       duration (default 2000)\n"
+        "  -s seed     random seed (default 1)\n",
+        name);
+}
+
+int main(const int argc, char** argv) {
+    int n_of_writers = 2, n_of_readers = 2, n_of_agers = 2, duration_ms = 2000, opt;
+    unsigned int seed = 1;
+    while ((opt = getopt(argc, argv, "w:r:a:t:s:h")) != -1) {
+        switch (opt) {
+            case 'w': n_of_writers = atoi(optarg); break;
+            case 'r': n_of_readers = atoi(optarg); break;
+            case 'a': n_of_agers = atoi(optarg); break;
+            case 't': duration_ms = atoi(optarg); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    const int n_of_threads = n_of_writers + n_of_readers + n_of_agers;
+    if (optind != argc || n_of_writers < 1 || n_of_readers < 1 || n_of_agers < 0 || n_of_threads > MAX_THREADS || duration_ms < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    count_bit_LUT_init();
+    for (int i = 0; i < N_OF_BOARDS; i++) random_board(&boards[i], &seed, &pieces[i]);
+    pthread_barrier_init(&barrier, NULL, n_of_threads + 1);
+    Worker workers[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    for (int i = 0; i < n_of_threads; i++) {
+        workers[i] = (Worker){i, seed + i, i < n_of_writers ? writer : i < n_of_writers + n_of_readers ? reader : ager};
+        pthread_create(&threads[i], NULL, start, &workers[i]);
+    }
+    pthread_barrier_wait(&barrier);
+    pthread_barrier_wait(&barrier);
+    map = init_shared_map(MAP_CAP);
+    pthread_barrier_wait(&barrier);
+    usleep(duration_ms * 1000);
+    atomic_store(&stop, true);
+    for (int i = 0; i < n_of_threads; i++) pthread_join(threads[i], NULL);
+
+    int errors = 0;
+    for (int i = 1; i < n_of_threads; i++) {
+        if (keys[i] != keys[0]) {
+            fprintf(stderr, "thread %d hashes boards with other keys (0x%08X, 0x%08X)\n", i, keys[i], keys[0]);
+            errors++;
+            break;
+        }
+    }
+    if (atomic_load(&max_age_seen) > MAX_AGE) {
+        fprintf(stderr, "age %d past MAX_AGE\n", atomic_load(&max_age_seen));
+        errors++;
+    }
+    const long long gets = atomic_load(&n_of_gets), hits = atomic_load(&n_of_hits);
+    printf("%d writers, %d readers, %d agers, %d ms: %lld puts, %lld gets, %lld hits (%.1f%%), %lld searches (max age %d)\n",
+           n_of_writers, n_of_readers, n_of_agers, duration_ms, atomic_load(&n_of_puts), gets, hits, 100.0 * hits / gets,
+           atomic_load(&n_of_searches), atomic_load(&max_age_seen));
+    printf("%lld torn or mixed entries returned\n", atomic_load(&n_of_mismatches));
+    free_shared_map(&map);
+    return errors > 0 || atomic_load(&n_of_mismatches) > 0 || hits == 0;
+}
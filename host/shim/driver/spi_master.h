@@ -0,0 +1,77 @@
+//
+// spi_master.h
+// Developed by the GAME2 Team.
+// Host shim of the ESP-IDF SPI master driver: every transaction is a full duplex transfer handed to the
+// device hook (a simulated chip) at once. Transactions, bytes and bus time at the device clock are counted.
+//
+
+#ifndef HOST_DRIVER_SPI_MASTER_H
+#define HOST_DRIVER_SPI_MASTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef enum { SPI1_HOST, SPI2_HOST, SPI3_HOST } spi_host_device_t;
+
+#define SPI_DMA_DISABLED 0
+#define SPI_TRANS_USE_RXDATA (1 << 2)
+#define SPI_TRANS_USE_TXDATA (1 << 3)
+
+typedef struct {
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+} spi_bus_config_t;
+
+typedef struct {
+    uint8_t mode;
+    int clock_speed_hz;
+    int spics_io_num;
+    uint32_t flags;
+    int queue_size;
+} spi_device_interface_config_t;
+
+typedef struct {
+    uint32_t flags;
+    size_t length;   // bits
+    size_t rxlength; // bits, 0 for length
+    void* user;
+    union {
+        const void* tx_buffer;
+        uint8_t tx_data[4];
+    };
+    union {
+        void* rx_buffer;
+        uint8_t rx_data[4];
+    };
+} spi_transaction_t;
+
+typedef struct HostSpiDevice* spi_device_handle_t;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* config, int dma_channel);
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* config,
+                             spi_device_handle_t* handle);
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t* transaction);
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t* transaction);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t* transaction, TickType_t wait);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t** transaction, TickType_t wait);
+
+/* Host side */
+// one transfer with CS low: tx bytes out, rx bytes in
+typedef void (*host_spi_transfer_t)(const uint8_t* tx, uint8_t* rx, size_t length);
+void host_spi_set_device_hook(host_spi_transfer_t hook); // one device on the bus, it gets every transfer
+
+typedef struct HostSpiCounts {
+    uint32_t transactions;
+    uint32_t bytes;
+    uint64_t bus_ns; // clock time of the bytes, without the driver's set up
+} HostSpiCounts;
+void host_spi_counts(HostSpiCounts* counts);
+
+#endif //HOST_DRIVER_SPI_MASTER_H
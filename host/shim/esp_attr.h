@@ -0,0 +1,12 @@
+//
+// esp_attr.h
+// Developed by the GAME2 Team.
+// Host shim of the ESP-IDF section attributes.
+//
+
+#ifndef HOST_ESP_ATTR_H
+#define HOST_ESP_ATTR_H
+
+#define IRAM_ATTR
+
+#endif //HOST_ESP_ATTR_H
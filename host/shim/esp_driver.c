@@ -0,0 +1,159 @@
+//
+// esp_driver.c
+// Developed by the GAME2 Team.
+// Host shim of the ESP-IDF SPI master and GPIO drivers (see shim/driver/spi_master.h and gpio.h).
+//
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+
+#define SPI_MAX_QUEUE 16
+
+struct HostSpiDevice {
+    int clock_speed_hz;
+    int queue_size;
+    spi_transaction_t* done[SPI_MAX_QUEUE]; // queued transactions, already transferred
+    int n_of_done;
+};
+
+static pthread_mutex_t spi_mutex = PTHREAD_MUTEX_INITIALIZER;
+static host_spi_transfer_t spi_hook = NULL;
+static HostSpiCounts spi_counts;
+
+static pthread_mutex_t gpio_mutex = PTHREAD_MUTEX_INITIALIZER;
+static host_gpio_output_t gpio_output_hook = NULL;
+static gpio_int_type_t gpio_intr[GPIO_NUM_MAX];
+static gpio_isr_t gpio_handler[GPIO_NUM_MAX];
+static void* gpio_handler_arg[GPIO_NUM_MAX];
+static int gpio_level[GPIO_NUM_MAX];
+
+void host_spi_set_device_hook(const host_spi_transfer_t hook) {
+    spi_hook = hook;
+}
+
+void host_spi_counts(HostSpiCounts* counts) {
+    pthread_mutex_lock(&spi_mutex);
+    *counts = spi_counts;
+    pthread_mutex_unlock(&spi_mutex);
+}
+
+esp_err_t spi_bus_initialize(const spi_host_device_t host, const spi_bus_config_t* config, const int dma_channel) {
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(const spi_host_device_t host, const spi_device_interface_config_t* config,
+                             spi_device_handle_t* handle) {
+    if (config->queue_size > SPI_MAX_QUEUE) return ESP_ERR_INVALID_ARG;
+    spi_device_handle_t device = calloc(1, sizeof(struct HostSpiDevice));
+    if (device == NULL) return ESP_FAIL;
+    device->clock_speed_hz = config->clock_speed_hz;
+    device->queue_size = config->queue_size;
+    *handle = device;
+    return ESP_OK;
+}
+
+// one transaction, CS low for all its bytes (transactions of different tasks don't interleave)
+static void transfer(const spi_device_handle_t device, spi_transaction_t* t) {
+    const size_t length = (t->length + 7) / 8;
+    uint8_t tx[64] = {0}, rx[64];
+    if (length > sizeof(tx)) abort(); // longer than any device of the tree
+    const uint8_t* out = t->flags & SPI_TRANS_USE_TXDATA ? t->tx_data : t->tx_buffer;
+    if (out != NULL) memcpy(tx, out, length);
+    pthread_mutex_lock(&spi_mutex);
+    if (spi_hook != NULL) spi_hook(tx, rx, length);
+    else memset(rx, 0xFF, length);
+    spi_counts.transactions++;
+    spi_counts.bytes += length;
+    spi_counts.bus_ns += (uint64_t)length * 8 * 1000000000 / device->clock_speed_hz;
+    pthread_mutex_unlock(&spi_mutex);
+    uint8_t* in = t->flags & SPI_TRANS_USE_RXDATA ? t->rx_data : t->rx_buffer;
+    if (in != NULL) memcpy(in, rx, t->rxlength > 0 ? (t->rxlength + 7) / 8 : length);
+}
+
+esp_err_t spi_device_transmit(const spi_device_handle_t handle, spi_transaction_t* transaction) {
+    transfer(handle, transaction);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_polling_transmit(const spi_device_handle_t handle, spi_transaction_t* transaction) {
+    transfer(handle, transaction);
+    return ESP_OK;
+}
+
+// transferred at once, get_trans_result returns them in order (one task uses the queue)
+esp_err_t spi_device_queue_trans(const spi_device_handle_t handle, spi_transaction_t* transaction, const TickType_t wait) {
+    if (handle->n_of_done == handle->queue_size) return ESP_FAIL;
+    transfer(handle, transaction);
+    handle->done[handle->n_of_done++] = transaction;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(const spi_device_handle_t handle, spi_transaction_t** transaction,
+                                      const TickType_t wait) {
+    if (handle->n_of_done == 0) return ESP_FAIL;
+    *transaction = handle->done[0];
+    memmove(&handle->done[0], &handle->done[1], --handle->n_of_done * sizeof(handle->done[0]));
+    return ESP_OK;
+}
+
+void host_gpio_set_output_hook(const host_gpio_output_t hook) {
+    gpio_output_hook = hook;
+}
+
+esp_err_t gpio_config(const gpio_config_t* config) {
+    pthread_mutex_lock(&gpio_mutex);
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (!(config->pin_bit_mask >> pin & 1)) continue;
+        gpio_intr[pin] = config->intr_type;
+        if (config->mode == GPIO_MODE_INPUT) gpio_level[pin] = 1; // inputs idle high (open drain IRQ lines)
+    }
+    pthread_mutex_unlock(&gpio_mutex);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(const gpio_num_t pin, const uint32_t level) {
+    if (pin < 0 || pin >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&gpio_mutex);
+    gpio_level[pin] = level != 0;
+    pthread_mutex_unlock(&gpio_mutex);
+    if (gpio_output_hook != NULL) gpio_output_hook(pin, level != 0);
+    return ESP_OK;
+}
+
+int gpio_get_level(const gpio_num_t pin) {
+    if (pin < 0 || pin >= GPIO_NUM_MAX) return 0;
+    pthread_mutex_lock(&gpio_mutex);
+    const int level = gpio_level[pin];
+    pthread_mutex_unlock(&gpio_mutex);
+    return level;
+}
+
+esp_err_t gpio_install_isr_service(const int flags) {
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(const gpio_num_t pin, const gpio_isr_t handler, void* arg) {
+    if (pin < 0 || pin >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&gpio_mutex);
+    gpio_handler[pin] = handler;
+    gpio_handler_arg[pin] = arg;
+    pthread_mutex_unlock(&gpio_mutex);
+    return ESP_OK;
+}
+
+void host_gpio_input(const gpio_num_t pin, const int level) {
+    if (pin < 0 || pin >= GPIO_NUM_MAX) return;
+    pthread_mutex_lock(&gpio_mutex);
+    const int old = gpio_level[pin];
+    gpio_level[pin] = level != 0;
+    const gpio_int_type_t intr = gpio_intr[pin];
+    const gpio_isr_t handler = gpio_handler[pin];
+    void* arg = gpio_handler_arg[pin];
+    pthread_mutex_unlock(&gpio_mutex);
+    if (handler == NULL || old == (level != 0)) return;
+    if (intr == GPIO_INTR_ANYEDGE || (intr == GPIO_INTR_NEGEDGE && level == 0) || (intr == GPIO_INTR_POSEDGE && level != 0))
+        handler(arg);
+}
@@ -0,0 +1,17 @@
+//
+// esp_random.h
+// Developed by the GAME2 Team.
+// Host shim of the ESP-IDF hardware random number generator.
+//
+
+#ifndef HOST_ESP_RANDOM_H
+#define HOST_ESP_RANDOM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static inline uint32_t esp_random(void) {
+    return (uint32_t)rand() << 16 ^ (uint32_t)rand();
+}
+
+#endif //HOST_ESP_RANDOM_H
@@ -0,0 +1,206 @@
+//
+// freertos.c
+// Developed by the GAME2 Team.
+// Host shim of the FreeRTOS tasks, notifications and queues on pthreads (see shim/freertos/FreeRTOS.h).
+//
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+struct HostTask {
+    pthread_mutex_t mutex;
+    pthread_cond_t notified;
+    uint32_t notifications;
+    TaskFunction_t function;
+    void* param;
+};
+
+struct HostQueue {
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty, not_full;
+    uint8_t* items;
+    UBaseType_t length, item_size, head, count;
+};
+
+static __thread TaskHandle_t current_task = NULL;
+
+static void init_cond(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static struct timespec deadline(const TickType_t wait) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    t.tv_sec += wait / 1000;
+    t.tv_nsec += (long)(wait % 1000) * 1000000;
+    if (t.tv_nsec >= 1000000000) {
+        t.tv_sec++;
+        t.tv_nsec -= 1000000000;
+    }
+    return t;
+}
+
+// waits on cond (mutex held) until woken or the deadline, returns false on timeout
+static bool wait_until(pthread_cond_t* cond, pthread_mutex_t* mutex, const TickType_t wait, const struct timespec* until) {
+    if (wait == 0) return false;
+    if (wait == portMAX_DELAY) return pthread_cond_wait(cond, mutex) == 0;
+    return pthread_cond_timedwait(cond, mutex, until) != ETIMEDOUT;
+}
+
+static TaskHandle_t new_task(const TaskFunction_t function, void* param) {
+    TaskHandle_t task = calloc(1, sizeof(struct HostTask));
+    if (task == NULL) return NULL;
+    pthread_mutex_init(&task->mutex, NULL);
+    init_cond(&task->notified);
+    task->function = function;
+    task->param = param;
+    return task;
+}
+
+static void* run_task(void* arg) {
+    current_task = arg;
+    current_task->function(current_task->param);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(const TaskFunction_t function, const char* name, const uint32_t stack, void* param,
+                                   const UBaseType_t priority, TaskHandle_t* handle, const BaseType_t core) {
+    TaskHandle_t task = new_task(function, param);
+    if (task == NULL) return pdFAIL;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, run_task, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    if (handle != NULL) *handle = task;
+    return pdPASS;
+}
+
+void vTaskDelete(const TaskHandle_t task) {
+    if (task == NULL || task == current_task) pthread_exit(NULL);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (current_task == NULL) current_task = new_task(NULL, NULL);
+    return current_task;
+}
+
+void vTaskDelay(const TickType_t ticks) {
+    const struct timespec t = {ticks / 1000, (long)(ticks % 1000) * 1000000};
+    nanosleep(&t, NULL);
+}
+
+TickType_t xTaskGetTickCount() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (TickType_t)(t.tv_sec * 1000 + t.tv_nsec / 1000000);
+}
+
+uint32_t ulTaskNotifyTake(const BaseType_t clear_on_exit, const TickType_t wait) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    const struct timespec until = deadline(wait);
+    pthread_mutex_lock(&task->mutex);
+    while (task->notifications == 0 && wait_until(&task->notified, &task->mutex, wait, &until)) {}
+    const uint32_t value = task->notifications;
+    if (value > 0) task->notifications = clear_on_exit ? 0 : value - 1;
+    pthread_mutex_unlock(&task->mutex);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(const TaskHandle_t task) {
+    pthread_mutex_lock(&task->mutex);
+    task->notifications++;
+    pthread_cond_signal(&task->notified);
+    pthread_mutex_unlock(&task->mutex);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(const TaskHandle_t task, BaseType_t* higher_priority_task_woken) {
+    xTaskNotifyGive(task);
+    if (higher_priority_task_woken != NULL) *higher_priority_task_woken = pdTRUE;
+}
+
+QueueHandle_t xQueueCreate(const UBaseType_t length, const UBaseType_t item_size) {
+    QueueHandle_t queue = calloc(1, sizeof(struct HostQueue));
+    if (queue == NULL) return NULL;
+    queue->items = malloc((size_t)length * item_size);
+    if (queue->items == NULL) {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->mutex, NULL);
+    init_cond(&queue->not_empty);
+    init_cond(&queue->not_full);
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+void vQueueDelete(const QueueHandle_t queue) {
+    pthread_mutex_destroy(&queue->mutex);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+    free(queue->items);
+    free(queue);
+}
+
+BaseType_t xQueueSend(const QueueHandle_t queue, const void* item, const TickType_t wait) {
+    const struct timespec until = deadline(wait);
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count == queue->length && wait_until(&queue->not_full, &queue->mutex, wait, &until)) {}
+    const bool sent = queue->count < queue->length;
+    if (sent) {
+        memcpy(queue->items + (size_t)((queue->head + queue->count) % queue->length) * queue->item_size, item,
+               queue->item_size);
+        queue->count++;
+        pthread_cond_signal(&queue->not_empty);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return sent ? pdTRUE : pdFALSE;
+}
+
+// receive and peek
+static BaseType_t take(const QueueHandle_t queue, void* item, const TickType_t wait, const bool remove) {
+    const struct timespec until = deadline(wait);
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count == 0 && wait_until(&queue->not_empty, &queue->mutex, wait, &until)) {}
+    const bool received = queue->count > 0;
+    if (received) {
+        memcpy(item, queue->items + (size_t)queue->head * queue->item_size, queue->item_size);
+        if (remove) {
+            queue->head = (queue->head + 1) % queue->length;
+            queue->count--;
+            pthread_cond_signal(&queue->not_full);
+        } else {
+            pthread_cond_signal(&queue->not_empty); // another reader may be waiting too
+        }
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return received ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(const QueueHandle_t queue, void* item, const TickType_t wait) {
+    return take(queue, item, wait, true);
+}
+
+BaseType_t xQueuePeek(const QueueHandle_t queue, void* item, const TickType_t wait) {
+    return take(queue, item, wait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->mutex);
+    const UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
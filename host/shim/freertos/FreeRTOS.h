@@ -0,0 +1,29 @@
+//
+// FreeRTOS.h
+// Developed by the GAME2 Team.
+// Host shim of the FreeRTOS API used by the game core and the radio driver: tasks are pthreads, a tick is a
+// millisecond of CLOCK_MONOTONIC. Priorities and cores are ignored.
+//
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY (TickType_t)0xffffffff
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portYIELD_FROM_ISR(woken) (void)(woken)
+
+#endif //HOST_FREERTOS_H
@@ -0,0 +1,21 @@
+//
+// queue.h
+// Developed by the GAME2 Team.
+// Host shim of the FreeRTOS queues: fixed size items copied in and out, FIFO order.
+//
+
+#ifndef HOST_FREERTOS_QUEUE_H
+#define HOST_FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef struct HostQueue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait);
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t wait); // like receive, the item stays queued
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#endif //HOST_FREERTOS_QUEUE_H
@@ -0,0 +1,30 @@
+//
+// task.h
+// Developed by the GAME2 Team.
+// Host shim of the FreeRTOS tasks and direct to task notifications.
+//
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef struct HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* param);
+
+// starts a detached thread, the stack size, priority and core are ignored
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack, void* param,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+#define xTaskCreate(function, name, stack, param, priority, handle) \
+    xTaskCreatePinnedToCore(function, name, stack, param, priority, handle, -1)
+void vTaskDelete(TaskHandle_t task); // only the calling task (NULL)
+TaskHandle_t xTaskGetCurrentTaskHandle(); // threads that weren't created by the shim get a handle too
+
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken);
+
+#endif //HOST_FREERTOS_TASK_H
@@ -0,0 +1,5 @@
+//
+// sdkconfig.h
+// Developed by the GAME2 Team.
+// Host shim of the generated menuconfig header: no CONFIG_ options, the code takes its defaults.
+//
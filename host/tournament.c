@@ -0,0 +1,316 @@
+//
+// tournament.c
+// Developed by the GAME2 Team.
+// Engine-vs-engine self-play between two configurations, with one forked worker per core and a
+// sequential probability ratio test (SPRT) that stops as soon as the result is statistically clear.
+// Every random opening is played twice with colours swapped, so neither engine profits from the first move.
+//
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "bot.h"
+#include "hashmap.h"
+#include "zobrist.h"
+
+#define MAX_WORKERS 64
+
+typedef struct Engine {
+    int depth;
+    int time_limit_ms; // per move, 0 = no limit
+    int node_limit;    // per move, 0 = no limit
+    int t_t_cap;
+    bool quiescence;
+    bool move_order;
+    bool canonical;
+} Engine;
+
+// result of one opening played twice, sent from a worker to the parent
+typedef struct PairResult {
+    int pair;
+    int points[2];             // points of engine A per game (2 win, 1 draw, 0 loss)
+    long long nodes[2];        // per engine
+    long long moves[2];        // per engine
+    double seconds[2];         // per engine
+} PairResult;
+
+static Engine engines[2];
+static Map tables[2]; // every engine keeps its own transposition table
+static int loaded_table = 0;
+
+static double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+// parses "d=5,t=0,n=0,T=15000,q=1,m=1,c=0" (missing keys keep their value)
+static bool parse_engine(const char* spec, Engine* engine) {
+    const char* c = spec;
+    while (*c != '\0') {
+        char key;
+        int value, len;
+        if (sscanf(c, "%c=%d%n", &key, &value, &len) != 2) return false;
+        switch (key) {
+            case 'd': engine->depth = value; break;
+            case 't': engine->time_limit_ms = value; break;
+            case 'n': engine->node_limit = value; break;
+            case 'T': engine->t_t_cap = value; break;
+            case 'q': engine->quiescence = value != 0; break;
+            case 'm': engine->move_order = value != 0; break;
+            case 'c': engine->canonical = value != 0; break;
+            default: return false;
+        }
+        c += len;
+        if (*c == ',') c++;
+        else if (*c != '\0') return false;
+    }
+    return engine->depth >= 1 && engine->depth <= MAX_SEARCH_DEPTH && engine->t_t_cap >= 1 &&
+           engine->time_limit_ms >= 0 && engine->node_limit >= 0;
+}
+
+static void print_engine(const char* name, const Engine* engine) {
+    printf("%s: depth %d, time %d ms, nodes %d, t_t %d, quiescence %d, move order %d, canonical %d\n", name,
+           engine->depth, engine->time_limit_ms, engine->node_limit, engine->t_t_cap,
+           engine->quiescence, engine->move_order, engine->canonical);
+}
+
+// loads the settings and transposition table of an engine into the bot
+static void select_engine(const int e) {
+    if (loaded_table != e) {
+        tables[loaded_table] = bot_swap_table(tables[e]);
+        loaded_table = e;
+    }
+    set_do_quiescence(engines[e].quiescence);
+    set_better_move_order(engines[e].move_order);
+    set_canonical_t_t(engines[e].canonical);
+    set_node_limit(engines[e].node_limit);
+}
+
+// random opening of n_of_plies pieces around the centre (alternating colours, white first) without a winner
+static Board random_opening(const int n_of_plies) {
+    Board board;
+    do {
+        board = (Board){0};
+        for (int i = 0; i < n_of_plies; i++) {
+            int x, y;
+            do {
+                x = 2 + random32() % (BOARD_SIZE - 4);
+                y = 2 + random32() % (BOARD_SIZE - 4);
+            } while (!place_piece(&board, x, y, i % 2 ? BLACK : WHITE));
+        }
+    } while (check_winner(&board) != '\0');
+    return board;
+}
+
+// plays a game from an opening, returns the points of engine A (2 win, 1 draw, 0 loss)
+static int play_game(Board board, const int n_of_plies, const int white_engine, PairResult* result) {
+    for (int e = 0; e < 2; e++) {
+        select_engine(e);
+        clear_bot();
+    }
+    char player = n_of_plies % 2 ? BLACK : WHITE;
+    for (int ply = n_of_plies; ply < BOARD_SIZE*BOARD_SIZE; ply++) {
+        const int e = player == WHITE ? white_engine : 1 - white_engine;
+        select_engine(e);
+        int score;
+        const double start = now();
+        const int move = bot_search(&board, player, engines[e].depth, engines[e].time_limit_ms, &score);
+        result->seconds[e] += now() - start;
+        result->nodes[e] += search_stats.nodes;
+        result->moves[e]++;
+        if (move < 0 || !place_piece(&board, move % BOARD_SIZE, move / BOARD_SIZE, player))
+            return e == 0 ? 0 : 2; // an engine without a legal move loses
+        const char winner = check_winner(&board);
+        if (winner == player) return e == 0 ? 2 : 0;
+        if (winner != '\0') return 1;
+        player = player == WHITE ? BLACK : WHITE;
+    }
+    return 1;
+}
+
+// plays the pairs worker, worker + n_of_workers, ... and writes every result to out
+static void worker(const int id, const int n_of_workers, const int n_of_pairs, const int n_of_plies,
+                   const uint32_t seed, const int out) {
+    seed_random(seed); // zobrist keys are the same in every worker
+    init_bot(engines[0].t_t_cap);
+    tables[1] = init_map(engines[1].t_t_cap);
+    for (int pair = id; pair < n_of_pairs; pair += n_of_workers) {
+        seed_random(seed ^ (uint32_t)(pair + 1) * 2654435761u);
+        const Board opening = random_opening(n_of_plies);
+        PairResult result = {.pair = pair};
+        for (int game = 0; game < 2; game++)
+            result.points[game] = play_game(opening, n_of_plies, game, &result);
+        if (write(out, &result, sizeof(result)) != sizeof(result)) break;
+    }
+    free_map(&tables[1 - loaded_table]);
+    free_bot();
+}
+
+// expected score of a player with an Elo advantage of elo
+static double elo_to_score(const double elo) {
+    return 1 / (1 + pow(10, -elo / 400));
+}
+
+static double score_to_elo(const double score) {
+    return -400 * log10(1 / score - 1);
+}
+
+// generalised SPRT log-likelihood ratio of H1 (elo1) against H0 (elo0) for win/draw/loss counts
+static double sprt_llr(const int wins, const int draws, const int losses, const double elo0, const double elo1) {
+    const int n = wins + draws + losses;
+    if (wins == 0 || losses == 0) return 0;
+    const double score = (wins + 0.5 * draws) / n;
+    const double variance = (wins * pow(1 - score, 2) + draws * pow(0.5 - score, 2) + losses * pow(score, 2)) / n;
+    const double s0 = elo_to_score(elo0), s1 = elo_to_score(elo1);
+    return (s1 - s0) * (2 * score - s0 - s1) / (2 * variance / n);
+}
+
+static void print_status(const int wins, const int draws, const int losses, const double llr,
+                         const double lower, const double upper) {
+    const int n = wins + draws + losses;
+    const double score = (wins + 0.5 * draws) / n;
+    const double variance = (wins * pow(1 - score, 2) + draws * pow(0.5 - score, 2) + losses * pow(score, 2)) / n;
+    const double margin = 1.96 * sqrt(variance / n);
+    const double low = score - margin > 0 ? score_to_elo(score - margin) : -INFINITY;
+    const double high = score + margin < 1 ? score_to_elo(score + margin) : INFINITY;
+    const double elo = score > 0 && score < 1 ? score_to_elo(score) : (score > 0 ? INFINITY : -INFINITY);
+    printf("games %6d  W %5d  D %5d  L %5d  elo %+7.1f [%+.1f, %+.1f]  LLR %+.2f [%.2f, %.2f]\n",
+           n, wins, draws, losses, elo, low, high, llr, lower, upper);
+    fflush(stdout);
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -a spec     engine A, the candidate (default d=5)\n"
+        "  -b spec     engine B, the baseline (default d=5)\n"
+        "              spec: comma separated d=depth, t=ms, n=nodes (per move), T=t_t entries,\n"
+        "              q=0|1 quiescence, m=0|1 move ordering, c=0|1 canonical keys\n"
+        "              a time or node limit searches with iterative deepening up to the depth\n"
+        "  -g games    maximum number of games (default 10000)\n"
+        "  -o plies    random opening plies (default 4)\n"
+        "  -j workers  parallel games (default: number of cores)\n"
+        "  -e elo0,elo1  SPRT hypotheses, Elo of A over B (default 0,5; use -5,0 for non-regression)\n"
+        "  -p alpha    SPRT error rates alpha = beta (default 0.05)\n"
+        "  -s seed     random seed (default 1)\n",
+        name);
+}
+
+int main(const int argc, char** argv) {
+    const Engine default_engine = {.depth = 5, .t_t_cap = 15000, .quiescence = true, .move_order = true};
+    engines[0] = engines[1] = default_engine;
+    int max_games = 10000, n_of_plies = 4, n_of_workers = (int)sysconf(_SC_NPROCESSORS_ONLN), opt;
+    double elo0 = 0, elo1 = 5, alpha = 0.05;
+    uint32_t seed = 1;
+    while ((opt = getopt(argc, argv, "a:b:g:o:j:e:p:s:h")) != -1) {
+        switch (opt) {
+            case 'a': if (!parse_engine(optarg, &engines[0])) { usage(argv[0]); return 2; } break;
+            case 'b': if (!parse_engine(optarg, &engines[1])) { usage(argv[0]); return 2; } break;
+            case 'g': max_games = atoi(optarg); break;
+            case 'o': n_of_plies = atoi(optarg); break;
+            case 'j': n_of_workers = atoi(optarg); break;
+            case 'e': if (sscanf(optarg, "%lf,%lf", &elo0, &elo1) != 2) { usage(argv[0]); return 2; } break;
+            case 'p': alpha = atof(optarg); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (max_games < 2 || n_of_plies < 0 || n_of_plies > 20 || n_of_workers < 1 || elo0 >= elo1 ||
+        alpha <= 0 || alpha >= 0.5) {
+        usage(argv[0]);
+        return 2;
+    }
+    const int n_of_pairs = max_games / 2;
+    if (n_of_workers > MAX_WORKERS) n_of_workers = MAX_WORKERS;
+    if (n_of_workers > n_of_pairs) n_of_workers = n_of_pairs;
+
+    print_engine("A", &engines[0]);
+    print_engine("B", &engines[1]);
+    printf("%d workers, up to %d games, SPRT elo0 %.1f elo1 %.1f alpha %.3f\n", n_of_workers, max_games, elo0, elo1, alpha);
+    fflush(stdout); // forked workers must not flush the parent's buffer again
+
+    // the engine uses globals, so games run in separate processes instead of threads
+    pid_t pids[MAX_WORKERS];
+    struct pollfd fds[MAX_WORKERS];
+    for (int w = 0; w < n_of_workers; w++) {
+        int fd[2];
+        if (pipe(fd) != 0) {
+            perror("pipe");
+            return 1;
+        }
+        pids[w] = fork();
+        if (pids[w] < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pids[w] == 0) {
+            close(fd[0]);
+            worker(w, n_of_workers, n_of_pairs, n_of_plies, seed, fd[1]);
+            close(fd[1]);
+            _exit(0);
+        }
+        close(fd[1]);
+        fds[w] = (struct pollfd){.fd = fd[0], .events = POLLIN};
+    }
+
+    const double lower = log(alpha / (1 - alpha)), upper = log((1 - alpha) / alpha);
+    int wins = 0, draws = 0, losses = 0, open_workers = n_of_workers;
+    long long total_nodes[2] = {0}, total_moves[2] = {0};
+    double total_seconds[2] = {0}, llr = 0;
+    const char* verdict = "inconclusive, game limit reached";
+    while (open_workers > 0) {
+        if (poll(fds, n_of_workers, -1) < 0) break;
+        for (int w = 0; w < n_of_workers; w++) {
+            if (fds[w].fd < 0 || fds[w].revents == 0) continue;
+            PairResult result;
+            if (read(fds[w].fd, &result, sizeof(result)) != sizeof(result)) { // worker finished
+                close(fds[w].fd);
+                fds[w].fd = -1;
+                open_workers--;
+                continue;
+            }
+            for (int game = 0; game < 2; game++) {
+                if (result.points[game] == 2) wins++;
+                else if (result.points[game] == 1) draws++;
+                else losses++;
+            }
+            for (int e = 0; e < 2; e++) {
+                total_nodes[e] += result.nodes[e];
+                total_moves[e] += result.moves[e];
+                total_seconds[e] += result.seconds[e];
+            }
+            llr = sprt_llr(wins, draws, losses, elo0, elo1);
+            if ((wins + draws + losses) % 100 == 0) print_status(wins, draws, losses, llr, lower, upper);
+            if (llr >= upper || llr <= lower) {
+                verdict = llr >= upper ? "H1 accepted (A is at least elo1 stronger)" : "H0 accepted (A is not elo1 stronger than elo0)";
+                open_workers = 0;
+                break;
+            }
+        }
+    }
+    for (int w = 0; w < n_of_workers; w++) {
+        kill(pids[w], SIGTERM);
+        waitpid(pids[w], NULL, 0);
+        if (fds[w].fd >= 0) close(fds[w].fd);
+    }
+
+    if (wins + draws + losses == 0) {
+        fprintf(stderr, "no games played\n");
+        return 1;
+    }
+    print_status(wins, draws, losses, llr, lower, upper);
+    for (int e = 0; e < 2; e++)
+        printf("%c: %.0f nodes/move, %.2f ms/move, %.0f nodes/s\n", 'A' + e,
+               (double)total_nodes[e] / total_moves[e], 1000 * total_seconds[e] / total_moves[e],
+               total_seconds[e] > 0 ? total_nodes[e] / total_seconds[e] : 0);
+    printf("%s\n", verdict);
+    return 0;
+}
@@ -0,0 +1,218 @@
+//
+// trace_analyze.c
+// Developed by the GAME2 Team.
+// Reads a search trace (gomoku_cli -o, or "TRACE <hex>" lines from the device log with -x) and reports
+// per-depth branching factors, move ordering quality (how often the first move cuts) and the hottest subtrees.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "bot.h"
+#include "trace.h"
+
+#define N_OF_HOT 10
+#define CUTOFF_BUCKETS 5 // cutoffs by move 1, 2, 3, 4-5, 6+
+
+typedef struct DepthStats {
+    long long nodes;
+    long long interior; // nodes that searched moves
+    long long generated;
+    long long searched;
+    long long cutoffs;
+    long long first_move_cutoffs;
+    long long t_t_hits;
+    long long t_t_cutoffs;
+    long long null_prunes;
+} DepthStats;
+
+static TraceRecord* records = NULL;
+static long long n_of_records = 0, cap = 0;
+
+static void add_record(const TraceRecord* record) {
+    if (n_of_records == cap) {
+        cap = cap == 0 ? 4096 : cap * 2;
+        records = realloc(records, cap * sizeof(TraceRecord));
+        if (records == NULL) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    records[n_of_records++] = *record;
+}
+
+// binary trace written by trace_open
+static bool read_binary(FILE* file) {
+    TraceHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, TRACE_MAGIC, 4) != 0 ||
+        header.version != TRACE_VERSION || header.record_size != sizeof(TraceRecord)) {
+        fprintf(stderr, "not a version %d trace\n", TRACE_VERSION);
+        return false;
+    }
+    TraceRecord record;
+    while (fread(&record, sizeof(record), 1, file) == 1) add_record(&record);
+    return true;
+}
+
+// "TRACE <hex>" lines of trace_dump_hex, any other line (device log) is skipped
+static bool read_hex(FILE* file) {
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        const char* hex = strstr(line, "TRACE ");
+        if (hex == NULL) continue;
+        hex += 6;
+        TraceRecord record;
+        uint8_t* bytes = (uint8_t*)&record;
+        int b;
+        for (b = 0; b < (int)sizeof(record); b++) {
+            unsigned int byte;
+            if (sscanf(hex + 2 * b, "%2x", &byte) != 1) break;
+            bytes[b] = (uint8_t)byte;
+        }
+        if (b == (int)sizeof(record)) add_record(&record);
+    }
+    return true;
+}
+
+static bool is_root(const TraceRecord* record) {
+    return record->ply == 0 && !(record->flags & (TRACE_QUIESCENCE | TRACE_NULL));
+}
+
+static double ratio(const double a, const double b) {
+    return b > 0 ? a / b : 0;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "usage: %s [-x] [-n hot] trace\n"
+        "  -x          trace is a device log with TRACE <hex> lines\n"
+        "  -n count    hottest subtrees to list (default %d)\n",
+        name, N_OF_HOT);
+}
+
+int main(const int argc, char** argv) {
+    bool hex = false;
+    int n_of_hot = N_OF_HOT, opt;
+    while ((opt = getopt(argc, argv, "xn:h")) != -1) {
+        switch (opt) {
+            case 'x': hex = true; break;
+            case 'n': n_of_hot = atoi(optarg); break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind != argc - 1 || n_of_hot < 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    FILE* file = fopen(argv[optind], hex ? "r" : "rb");
+    if (file == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+    const bool ok = hex ? read_hex(file) : read_binary(file);
+    fclose(file);
+    if (!ok) return 1;
+
+    DepthStats depths[MAX_SEARCH_DEPTH + 1] = {0};
+    DepthStats quiescence = {0};
+    long long cutoff_index[CUTOFF_BUCKETS] = {0};
+    long long searches = 0, root_nodes = 0, null_nodes = 0, aborted = 0;
+    for (long long i = 0; i < n_of_records; i++) {
+        const TraceRecord* r = &records[i];
+        if (r->flags & TRACE_ABORTED) {
+            aborted++;
+            continue;
+        }
+        if (is_root(r)) {
+            searches++;
+            root_nodes += r->nodes;
+        }
+        if (r->flags & TRACE_NULL) {
+            null_nodes++;
+            continue;
+        }
+        DepthStats* d = r->flags & TRACE_QUIESCENCE ? &quiescence : &depths[r->depth < 0 ? 0 : r->depth > MAX_SEARCH_DEPTH ? MAX_SEARCH_DEPTH : r->depth];
+        d->nodes++;
+        if (r->flags & TRACE_T_T_HIT) d->t_t_hits++;
+        if (r->flags & TRACE_T_T_CUTOFF) d->t_t_cutoffs++;
+        if (r->flags & TRACE_NULL_PRUNE) d->null_prunes++;
+        if (r->searched > 0) {
+            d->interior++;
+            d->generated += r->n_of_moves;
+            d->searched += r->searched;
+        }
+        if (r->flags & TRACE_CUTOFF) {
+            d->cutoffs++;
+            if (r->searched == 1) d->first_move_cutoffs++;
+            if (!(r->flags & TRACE_QUIESCENCE)) {
+                const int n = r->searched;
+                cutoff_index[n <= 3 ? n - 1 : n <= 5 ? 3 : 4]++;
+            }
+        }
+    }
+
+    printf("records %lld, searches %lld, nodes %lld, null move nodes %lld, aborted %lld\n\n",
+           n_of_records, searches, root_nodes, null_nodes, aborted);
+    printf("%5s %10s %8s %9s %9s %8s %9s %8s %8s\n", "depth", "nodes", "ebf", "generated", "searched",
+           "cutoff", "1st move", "t_t hit", "t_t cut");
+    for (int d = MAX_SEARCH_DEPTH; d >= 0; d--) {
+        const DepthStats* s = &depths[d];
+        if (s->nodes == 0) continue;
+        // ebf: nodes one depth lower per node at this depth (null move nodes excluded)
+        const double ebf = d > 0 ? ratio(depths[d-1].nodes, s->nodes) : 0;
+        printf("%5d %10lld %8.2f %9.2f %9.2f %7.1f%% %8.1f%% %7.1f%% %7.1f%%\n", d, s->nodes, ebf,
+               ratio(s->generated, s->interior), ratio(s->searched, s->interior), 100 * ratio(s->cutoffs, s->interior),
+               100 * ratio(s->first_move_cutoffs, s->cutoffs), 100 * ratio(s->t_t_hits, s->nodes),
+               100 * ratio(s->t_t_cutoffs, s->nodes));
+    }
+    printf("%5s %10lld %8s %9.2f %9.2f %7.1f%% %8.1f%% %7.1f%% %7.1f%%\n\n", "q", quiescence.nodes, "",
+           ratio(quiescence.generated, quiescence.interior), ratio(quiescence.searched, quiescence.interior),
+           100 * ratio(quiescence.cutoffs, quiescence.interior), 100 * ratio(quiescence.first_move_cutoffs, quiescence.cutoffs),
+           100 * ratio(quiescence.t_t_hits, quiescence.nodes), 100 * ratio(quiescence.t_t_cutoffs, quiescence.nodes));
+
+    long long total_cutoffs = 0;
+    for (int i = 0; i < CUTOFF_BUCKETS; i++) total_cutoffs += cutoff_index[i];
+    static const char* bucket_names[CUTOFF_BUCKETS] = {"1", "2", "3", "4-5", "6+"};
+    printf("minimax cutoffs by move index:");
+    for (int i = 0; i < CUTOFF_BUCKETS; i++)
+        printf("  %s: %.1f%%", bucket_names[i], 100 * ratio(cutoff_index[i], total_cutoffs));
+    printf("\n\n");
+
+    // hottest subtrees below the root: records are written after their subtree, so the root of a
+    // record is the next root record
+    long long* hot = calloc(n_of_hot + 1, sizeof(long long));
+    uint32_t* hot_root_nodes = calloc(n_of_hot + 1, sizeof(uint32_t));
+    int n_hot = 0;
+    uint32_t root = 0;
+    for (long long i = n_of_records - 1; i >= 0; i--) {
+        const TraceRecord* r = &records[i];
+        if (is_root(r)) root = r->nodes;
+        if (r->ply == 0 || r->ply > 2 || r->flags & (TRACE_NULL | TRACE_QUIESCENCE | TRACE_ABORTED)) continue;
+        int pos = n_hot;
+        while (pos > 0 && records[hot[pos-1]].nodes < r->nodes) {
+            if (pos < n_of_hot) {
+                hot[pos] = hot[pos-1];
+                hot_root_nodes[pos] = hot_root_nodes[pos-1];
+            }
+            pos--;
+        }
+        if (pos < n_of_hot) {
+            hot[pos] = i;
+            hot_root_nodes[pos] = root;
+            if (n_hot < n_of_hot) n_hot++;
+        }
+    }
+    if (n_hot > 0) printf("hottest subtrees (ply 1-2)\n%4s %5s %8s %10s %10s %8s %12s\n", "ply", "depth", "move", "key", "nodes", "search", "result");
+    for (int i = 0; i < n_hot; i++) {
+        const TraceRecord* r = &records[hot[i]];
+        printf("%4d %5d %3d (%d,%d) %10u %10u %7.1f%% %12d\n", r->ply, r->depth, r->move,
+               r->move % BOARD_SIZE, r->move / BOARD_SIZE, r->key, r->nodes,
+               100 * ratio(r->nodes, hot_root_nodes[i]), r->result);
+    }
+    free(hot);
+    free(hot_root_nodes);
+    free(records);
+    return 0;
+}
@@ -20,7 +20,4 @@ void gatt_svr_register_cb(struct ble_gatt_register_ctxt *ctxt, void *arg);
 void gatt_svr_subscribe_cb(struct ble_gap_event *event);
 int gatt_svc_init(void);
 
-// send safety system data to app via BLE after interrupt from nRF24
-void send_safety_system_indication(uint8_t trigger);
-
 #endif // GATT_SVR_H
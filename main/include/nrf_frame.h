@@ -0,0 +1,73 @@
+//
+// nrf_frame.h
+// Developed by the GAME2 Team.
+// Radio frames between the ESP32 and the PIC, sent with the nRF24 dynamic payload length (up to 32 bytes),
+// also used for the ACK payloads of the PIC:
+//   message, message, ..., crc16 (little endian, over the messages)
+//   message: type, seq, length, length bytes of data
+// Seqs count the messages of each type and wrap at 256. A receiver applies a message only when its seq is after
+// the last one of its type (a frame resent after MAX_RT repeats all its messages), so fewer than 128 messages of
+// a type may be in flight. After a boot a device starts its frames with a restart message until one is
+// acknowledged: its seqs start over, and the other end forgets the seqs it had from it.
+//
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NRF_FRAME_MAX_SIZE      32
+#define NRF_FRAME_CRC_SIZE      2
+#define NRF_MESSAGE_HEADER_SIZE 3
+#define NRF_MESSAGE_MAX_SIZE    (NRF_FRAME_MAX_SIZE - NRF_FRAME_CRC_SIZE - NRF_MESSAGE_HEADER_SIZE)
+#define NRF_FRAME_MAX_MESSAGES  ((NRF_FRAME_MAX_SIZE - NRF_FRAME_CRC_SIZE) / NRF_MESSAGE_HEADER_SIZE)
+
+// message types
+#define NRF_MSG_MOVE            0x01 // ESP32 -> PIC: the bot's move (cell index)
+#define NRF_MSG_SAFETY          0x02 // PIC -> ESP32: safety system state, non zero when triggered
+#define NRF_MSG_STATUS          0x03 // PIC -> ESP32 in ACK payloads: safety system state, seq of the last move played
+#define NRF_MSG_RESTART         0x04 // both ways, at the head of the frames after a boot: boot id (random)
+#define NRF_MSG_TYPES           0x05
+
+#define NRF_RESTART_LENGTH      4    // boot id, little endian
+
+typedef struct {
+    uint8_t type;
+    uint8_t seq;    // by type, a resend keeps the seq of the message, the receiver applies it once
+    uint8_t length;
+    uint8_t data[NRF_MESSAGE_MAX_SIZE];
+} nrf_message_t;
+
+typedef struct {
+    uint8_t data[NRF_FRAME_MAX_SIZE];
+    uint8_t length;
+    uint8_t n_of_messages;
+} nrf_frame_t;
+
+void nrf_frame_init(nrf_frame_t *frame);
+
+// appends a message, returns false when it doesn't fit in the frame
+bool nrf_frame_add(nrf_frame_t *frame, const nrf_message_t *message);
+
+// appends the CRC, the frame is ready to send
+void nrf_frame_finish(nrf_frame_t *frame);
+
+// splits a received frame, returns the number of messages or -1 when the CRC or a length is wrong
+int nrf_frame_parse(const uint8_t *data, size_t length, nrf_message_t *messages, int max_messages);
+
+// what a receiver knows of the messages of its peer
+typedef struct {
+    int16_t last_seq[NRF_MSG_TYPES]; // seq of the last message applied by type, -1 for none
+    uint32_t boot_id;
+    bool has_boot_id;
+} nrf_rx_state_t;
+
+void nrf_rx_state_init(nrf_rx_state_t *state);
+
+// returns true when a received message is to be applied: its seq is after the last one of its type, or it is the
+// restart message of a new boot of the peer (the seqs of the previous boot are forgotten). Repeated messages are dropped
+bool nrf_rx_accept(nrf_rx_state_t *state, const nrf_message_t *message);
+
+// the restart message a device sends after its boot
+nrf_message_t nrf_restart_message(uint32_t boot_id);
+
+uint16_t nrf_crc16(const uint8_t *data, size_t length);
@@ -13,6 +13,7 @@
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
 #include "sdkconfig.h"
+#include "nrf_frame.h"
 
 #define SPI_HOST        SPI2_HOST
 #define PIN_NUM_MISO    11
@@ -21,7 +22,7 @@
 #define NRF_CE_PIN      10
 #define NRF_CSN_PIN     5
 #define NRF_IRQ_PIN     6   
-#define SPI_CLOCK_SPEED 1000000  //（1MHz）
+#define SPI_CLOCK_SPEED 8000000  // (8MHz) the nRF24L01 takes up to 10MHz, margin for the wiring
 
 // nRF24L01 register address
 #define NRF_REG_CONFIG      0x00
@@ -33,6 +34,8 @@
 #define NRF_REG_RX_ADDR_P0  0x0A
 #define NRF_REG_RX_PW_P0    0x11 //
 #define NRF_REG_FIFO_STATUS 0x17
+#define NRF_REG_DYNPD       0x1C
+#define NRF_REG_FEATURE     0x1D
 
 // nRF24L01 command code
 #define NRF_CMD_W_REGISTER  0x20
@@ -41,6 +44,8 @@
 #define NRF_CMD_FLUSH_RX    0xE2
 #define NRF_CMD_W_TX_PAYLOAD 0xA0
 #define NRF_CMD_R_RX_PAYLOAD 0x61
+#define NRF_CMD_R_RX_PL_WID 0x60
+#define NRF_CMD_ACTIVATE    0x50
 
 /// Configurations of the spi_nrf
 typedef struct {
@@ -58,7 +63,22 @@ void nrf_write_register_multi(uint8_t reg, uint8_t *data, size_t length);
 
 void nrf_check_configuration(void);
 
-void nrf_send_data(uint8_t *data, size_t length);
+// called by the radio task when the frame of a message was delivered (TX_DS) or given up on
+typedef void (*nrf_tx_callback_t)(const nrf_message_t *message, bool delivered);
+
+// queues a message for the radio task, which packs the queued messages into frames. Returns false when
+// the queue is full (never blocks). Resend a message with its seq, the PIC applies it once
+bool nrf_send_message(const nrf_message_t *message);
+
+void nrf_set_tx_callback(nrf_tx_callback_t callback);
+
+// called by the radio task for every message received (repeated seqs are dropped)
+typedef void (*nrf_rx_callback_t)(const nrf_message_t *message);
+
+void nrf_set_rx_callback(nrf_rx_callback_t callback);
+
+// wakes the radio task, call from the ISR of the IRQ line
+void nrf_irq_from_isr();
 
 void nrf_clear_interrupts();
 
@@ -24,8 +24,15 @@
 #include "gap.h"
 #include "gatt_svc.h"
 #include "src/bot.h"
+#include "src/dlog.h"
+#include "src/game.h"
+#include "src/game_line.h"
 #include <time.h>
 
+#ifdef CONFIG_GOMOKU_MICROBENCH
+void run_microbenchmarks(const char* name_filter); // host/microbench.c
+#endif
+
 #define SAFETY_TASK_PERIOD (100 / portTICK_PERIOD_MS)
 
 /* Library function declarations */
@@ -75,25 +82,9 @@ static void nimble_host_task(void *param) {
     vTaskDelete(NULL);
 }
 
-// task started by interrupt received from nRF24
-void safety_interrupt_handler() {
-    /* Task entry log */
-    printf("Interrupt triggered\n");
-    uint8_t data = 0;
-    nrf_read_payload(&data, 1);
-    nrf_clear_interrupts();
-
-    printf("data (from safety system interrupt): %d\n", data);
-    /* Send if safety triggered */
-    if (data) {
-        send_safety_system_indication(data);
-    }
-    vTaskDelete(NULL);
-}
-
-// ISR from nRF24 interrupt
-static void IRAM_ATTR safety_task() {
-    xTaskCreate(safety_interrupt_handler, "safety_interrupt_handler", 41024, NULL, 5, NULL);
+// ISR from nRF24 interrupt, the radio task reads the radio
+static void IRAM_ATTR nrf_irq_handler(void *arg) {
+    nrf_irq_from_isr();
 }
 
 void app_main(void) {
@@ -102,12 +93,28 @@ void app_main(void) {
     esp_err_t ret;
 
     printf("%d\n", heap_caps_get_largest_free_block(MALLOC_CAP_8BIT)); // shows space available for transposition table
+#ifdef CONFIG_GOMOKU_MICROBENCH
+    run_microbenchmarks(NULL);
+    return;
+#endif
+    dlog_init(); // deferred log of the move path
     init_bot(15000);
 
     // /* Initialize SPI */
     nrf_init();
     nrf_check_configuration();
 
+    // game core: the bot's moves go to the PIC, its safety system reaches the front ends
+    if (!game_init(nrf_send_message)) {
+        ESP_LOGE(TAG, "failed to start the search task");
+        return;
+    }
+    nrf_set_tx_callback(game_radio_delivered);
+    nrf_set_rx_callback(game_pic_message);
+#if CONFIG_GOMOKU_LINE_PROTOCOL
+    if (!game_line_start_uart()) ESP_LOGE(TAG, "failed to start the line protocol");
+#endif
+
     // set up interrupt pin and ISR
     gpio_config_t io_conf = {
         .pin_bit_mask = 1ULL << NRF_IRQ_PIN,
@@ -118,7 +125,7 @@ void app_main(void) {
     };
     gpio_config(&io_conf);
     gpio_install_isr_service(0);
-    gpio_isr_handler_add(NRF_IRQ_PIN, safety_task, NULL);
+    gpio_isr_handler_add(NRF_IRQ_PIN, nrf_irq_handler, NULL);
 
     /*
      * NVS flash initialization
@@ -160,8 +167,8 @@ void app_main(void) {
     /* NimBLE host configuration initialization */
     nimble_host_config_init();
 
-    /* Start NimBLE host task thread and return */
-    xTaskCreate(nimble_host_task, "NimBLE Host", 4*1024, NULL, 5, NULL);
+    /* Start NimBLE host task thread and return (pinned next to the controller, searches run on the other core) */
+    xTaskCreatePinnedToCore(nimble_host_task, "NimBLE Host", 4*1024, NULL, 5, NULL, 0);
 
     // srand(2);
     // Board* board = create_board();
@@ -8,12 +8,19 @@
 #include <string.h>
 
 uint8_t BitsSetTable[1 << BOARD_SIZE];
+uint16_t ReverseTable[1 << BOARD_SIZE]; // row with its BOARD_SIZE bits mirrored
 
-// Initialise the lookup table for counting set bits
+// Initialise the lookup tables for counting set bits and mirroring rows
 void count_bit_LUT_init() {
     BitsSetTable[0] = 0;
     for (int i = 0; i < 1 << BOARD_SIZE; i++)
         BitsSetTable[i] = (i & 1) + BitsSetTable[i / 2];
+    for (int i = 0; i < 1 << BOARD_SIZE; i++) {
+        ReverseTable[i] = 0;
+        for (int j = 0; j < BOARD_SIZE; j++)
+            if (i & 1 << j)
+                ReverseTable[i] |= 1 << (BOARD_SIZE-1-j);
+    }
 }
 
 void print_board(const Board* board) {
@@ -340,5 +347,58 @@ Board* copy_board(const Board* board) {
     return new_board;
 }
 
+// transposes a bit board (x <-> y)
+static void transpose_bb(const uint16_t* bb_in, uint16_t* bb_out) {
+    for (int i = 0; i < BOARD_SIZE; i++)
+        bb_out[i] = 0;
+    for (int y = 0; y < BOARD_SIZE; y++) {
+        if (!bb_in[y]) continue;
+        for (int x = 0; x < BOARD_SIZE; x++)
+            if (bb_in[y] & 1 << (15-x))
+                bb_out[x] |= 1 << (15-y);
+    }
+}
 
+// applies one of the 8 board symmetries: bit 2 transposes, then bit 0 mirrors x and bit 1 mirrors y
+void transform_board(const Board* board, Board* out, const int sym) {
+    Board temp;
+    if (sym & 4) {
+        transpose_bb(board->black, temp.black);
+        transpose_bb(board->white, temp.white);
+    } else {
+        temp = *board;
+    }
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        const int row = sym & 2 ? BOARD_SIZE-1-i : i;
+        out->black[i] = sym & 1 ? ReverseTable[temp.black[row] >> (16-BOARD_SIZE)] << (16-BOARD_SIZE) : temp.black[row];
+        out->white[i] = sym & 1 ? ReverseTable[temp.white[row] >> (16-BOARD_SIZE)] << (16-BOARD_SIZE) : temp.white[row];
+    }
+}
+
+// maps a move to the board given by transform_board with the same symmetry
+int transform_move(const int move, const int sym) {
+    if (move < 0) return move;
+    int x = move % BOARD_SIZE, y = move / BOARD_SIZE;
+    if (sym & 4) {
+        const int temp = x;
+        x = y;
+        y = temp;
+    }
+    if (sym & 1) x = BOARD_SIZE-1-x;
+    if (sym & 2) y = BOARD_SIZE-1-y;
+    return y * BOARD_SIZE + x;
+}
 
+// maps a move on a transformed board back to the original board
+int inverse_transform_move(const int move, const int sym) {
+    if (move < 0) return move;
+    int x = move % BOARD_SIZE, y = move / BOARD_SIZE;
+    if (sym & 1) x = BOARD_SIZE-1-x;
+    if (sym & 2) y = BOARD_SIZE-1-y;
+    if (sym & 4) {
+        const int temp = x;
+        x = y;
+        y = temp;
+    }
+    return y * BOARD_SIZE + x;
+}
@@ -17,6 +17,7 @@
 #define BLACK 'X'
 #define WHITE2 'A'
 #define BLACK2 'B'
+#define N_OF_SYMMETRIES 8 // rotations and reflections of the board
 
 typedef enum Direction {HORIZONTAL, VERTICAL, DIAGONAL_FORWARD, DIAGONAL_BACK} Direction;
 
@@ -68,5 +69,11 @@ Board* create_next_board(const Board* board, int move, char player);
 
 Board* copy_board(const Board* board);
 
+void transform_board(const Board* board, Board* out, int sym);
+
+int transform_move(int move, int sym);
+
+int inverse_transform_move(int move, int sym);
+
 
 #endif //BOARD_H
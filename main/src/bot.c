@@ -8,17 +8,62 @@
 
 #include "Board.h"
 #include "hashmap.h"
+#include "dlog.h"
+#include "profile.h"
+#include "trace.h"
+#include "zobrist.h"
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
 Map transposition_table;
+EvalCache eval_cache; // static evaluations, kept across searches and games
+SearchPly* search_stack; // one preallocated SearchPly per ply, so the search never allocates
+
+enum { NODE_MINIMAX, NODE_QUIESCENCE };
+enum { STAGE_ENTER, STAGE_HORIZON, STAGE_NULL, STAGE_MOVES };
+
+// state of a node of the explicit stack search (locals of minimax_node/quiescence_node)
+typedef struct SearchNode {
+    const Board* board;
+    int* move;        // best move output (root only)
+    const data* t_t_entry;
+    uint64_t profile_start; // start of the quiescence phase (GOMOKU_PROFILE)
+    uint32_t key;
+    int alpha, beta, depth, ply;
+    int n_of_pieces, sym;
+    int best_eval, best_move;
+    int n_of_moves, i; // moves generated, index of the move being searched
+    char player;
+    uint8_t kind, stage;
+    bool null;
+} SearchNode;
+
+static SearchNode* search_nodes; // node stack, MAX_PLY + 1 entries (a horizon node and its quiescence search share a ply)
+static int search_top = -1;      // node being searched (-1 = no search)
+static int search_value;         // result of the last node that returned
+
 bool do_quiescence = true;
 bool better_move_order = true;
+bool canonical_t_t = false;
+int search_node_limit = 0; // nodes a search may visit (0 = no limit)
+bool iterative_search = true; // bot_search uses the explicit stack search (false: recursive minimax)
+void (*search_yield)() = NULL; // called between slices of the explicit stack search
+uint32_t search_slice_nodes = 0; // nodes per slice
 
-// initialize bot (transposition table and look up table)
+// initialize bot (transposition table, search stack and look up table)
 void init_bot(const int t_t_cap) {
     transposition_table = init_map(t_t_cap);
+    eval_cache = init_eval_cache(EVAL_CACHE_CAP);
+    search_stack = malloc(sizeof(SearchPly) * MAX_PLY);
+    search_nodes = malloc(sizeof(SearchNode) * (MAX_PLY + 1));
     count_bit_LUT_init();
 }
 
@@ -32,56 +77,269 @@ void set_better_move_order(const bool new) {
     better_move_order = new;
 }
 
+// use symmetry-canonical transposition table keys for positions with few pieces
+void set_canonical_t_t(const bool new) {
+    canonical_t_t = new;
+}
+
+// search with the explicit stack search (constant stack use) or the recursive minimax
+void set_iterative_search(const bool new) {
+    iterative_search = new;
+}
+
+// the explicit stack search calls yield every slice_nodes nodes (NULL = never suspend)
+void set_search_yield(void (*yield)(), const uint32_t slice_nodes) {
+    search_yield = slice_nodes > 0 ? yield : NULL;
+    search_slice_nodes = slice_nodes;
+}
+
+// searches use iterative deepening and stop after node_limit nodes (0 = no limit)
+void set_node_limit(const int node_limit) {
+    search_node_limit = node_limit;
+}
+
+// replaces the transposition table (e.g. one table per engine in self-play), returns the previous one
+Map bot_swap_table(const Map table) {
+    const Map previous = transposition_table;
+    transposition_table = table;
+    return previous;
+}
+
+// transposition table key of a board, sym is the symmetry to map moves into the stored board
+static uint32_t t_t_key(const Board* board, const int n_of_pieces, int* sym) {
+    if (canonical_t_t && n_of_pieces <= CANONICAL_MAX_PIECES)
+        return canonical_hash_board(board, sym);
+    *sym = 0;
+    return hash_board(board);
+}
+
 int total_evaluations = 0; // total number of evaluations in a game
 
-int collisions = 0; // number of transposition table collisions
-int lookups = 0; // number of successful transposition table lookups
-int evaluations = 0; // number of evaluations in a search
-int q_evaluations = 0; // number of quiescence evaluations in a search
-int f_pruning = 0; // number of foward prunes (NOT USED)
-int f_pruning1 = 0; // number of extended foward prunes (NOT USED)
-int null_pruning = 0; // number of null prunes
-int delta_pruning = 0; // number of delta prunes (NOT USED)
 int turn_count = 0; // number of turns
+SearchStats search_stats; // statistics of the current/last search
+
+bool search_aborted = false; // set when the search ran out of time, partial results are thrown away
+clock_t search_deadline = 0; // clock() at which the search stops (0 = no limit)
+bool search_limited = false; // set once a move is known, the limits only apply from then on
+static uint8_t score_age = 0; // the scores of older table entries aren't used, only their best moves (0: all are used)
+static const char* search_stack_base; // frame of bot_search
+static const char* search_stack_low;  // lowest node frame of the search (the stack grows down)
 
-// Searches best next move from a Board state
+volatile bool search_cancelled = false; // set by another task to stop the search, cleared by set_search_cancelled(false)
+
+// an iteration of an iterative deepening search only orders its moves with the entries of earlier turns and
+// iterations: their scores, bounds stored as exact ones, would answer the shallow iterations and cut away most
+// of the deeper ones
+static bool is_score_entry(const data* t_t_entry) {
+    return t_t_entry != NULL && t_t_entry->age >= score_age;
+}
+
+// checks (every 1024 nodes) if the search has to stop
+static bool out_of_time() {
+    if (!search_aborted && (search_stats.nodes & 1023) == 0 && (search_cancelled || (search_limited &&
+        ((search_node_limit != 0 && search_stats.nodes >= (uint32_t)search_node_limit) || (search_deadline != 0 && clock() >= search_deadline)))))
+        search_aborted = true;
+    return search_aborted;
+}
+
+// stops the running search (from another task), its result is meaningless; stays set until cleared
+void set_search_cancelled(const bool cancelled) {
+    search_cancelled = cancelled;
+}
+
+bool is_search_cancelled() {
+    return search_cancelled;
+}
+
+// microseconds between two clock() readings
+static uint32_t elapsed_us(const clock_t start, const clock_t end) {
+    return (uint32_t)((long long)(end - start) * 1000000 / CLOCKS_PER_SEC);
+}
+
+// logs the statistics of a bot move, a few records with integer arguments (see dlog.h)
+static void log_search_stats(const SearchStats* stats) {
+    const uint32_t ebf = (uint32_t)(effective_branching_factor(stats) * 100);
+    DLOG_I("bot", "time: %u ms, depth: %d, nodes: %u (quiescence %u)", stats->time_us / 1000, stats->reached_depth,
+           stats->nodes, stats->q_nodes);
+    DLOG_I("bot", "t_table probes: %u hits: %u cutoffs: %u stores: %u overwrites: %u", stats->t_t_probes,
+           stats->t_t_hits, stats->t_t_cutoffs, stats->t_t_stores, stats->t_t_overwrites);
+    DLOG_I("bot", "evaluations: %u (cache hits %u, quiescent %u), null pruning: %u", stats->evaluations,
+           stats->eval_cache_hits, stats->q_evaluations, stats->null_prunes);
+    DLOG_I("bot", "cutoffs: %u (first move %u), branching factor: %u.%02u", stats->cutoffs,
+           stats->first_move_cutoffs, ebf / 100, ebf % 100);
+    if (stats->max_ply > 0)
+        DLOG_I("bot", "stack: %u bytes to ply %d (%u per ply)", stats->stack_bytes, stats->max_ply,
+               stats->stack_bytes / stats->max_ply);
+#ifdef ESP_PLATFORM
+    DLOG_I("bot", "task stack high water: %u bytes free, heap free: %u bytes, lowest since boot: %u",
+           stats->stack_free_min, stats->heap_free, stats->heap_free_min);
+#endif
+}
+
+// Searches best next move from a Board state, logs search statistics
 int bot_place_piece(const Board* board, const char player, const int max_depth) {
+    int score;
+    const int move = bot_search(board, player, max_depth, 0, &score);
+    total_evaluations += search_stats.evaluations;
+    DLOG_I("bot", "turn: %d, score: %d, t_table size: %d", ++turn_count, score, transposition_table.size);
+    log_search_stats(&search_stats);
+    PROFILE_PRINT();
+    TRACE_DUMP();
+    // empty_map(&transposition_table);
+    return move;
+}
+
+// searches from the root with the explicit stack search or the recursive minimax
+static int search_root(const Board* board, const char player, const int depth, int* move) {
+    if (iterative_search) return iterative_minimax(board, player, INT_MIN, INT_MAX, depth, move);
+    return minimax(board, player, INT_MIN, INT_MAX, depth, 0, move, false);
+}
+
+// Searches best next move from a Board state up to max_depth, or until time_limit_ms or the node limit runs out (0 = no limit)
+int bot_search(const Board* board, const char player, const int max_depth, const int time_limit_ms, int* score) {
     int move = -1;
-    collisions = 0;
-    lookups = 0;
-    evaluations = 0;
-    q_evaluations = 0;
-    f_pruning = 0;
-    f_pruning1 = 0;
-    null_pruning = 0;
-    delta_pruning = 0;
     const clock_t start_time = clock();
-    // move = iterative_deepening_search(board, player, max_depth);
-    const int score = minimax(board, player, INT_MIN, INT_MAX, max_depth, &move, false);
-    total_evaluations += evaluations;
-    printf("Turn: %d\n", ++turn_count);
-    printf("time: %.3f\n", (double)(clock() - start_time) / CLOCKS_PER_SEC);
-    printf("score: %d\n", score);
-    printf("t_table size: %d\n", transposition_table.size);
-    printf("lookup:      %d\n", lookups);
-    // printf("collision:   %d\n", collisions);
-    printf("evaluations: %d\n", evaluations);
-    printf("quiescent evaluations: %d\n", q_evaluations);
-    // printf("delta pruning: %d\n", delta_pruning);
-    // printf("foward pruning: %d\n", f_pruning);
-    // printf("no foward pruning: %d\n", f_pruning1);
-    printf("null pruning: %d\n", null_pruning);
-    // empty_map(&transposition_table);
+    memset(&search_stats, 0, sizeof(search_stats));
+    search_stack_base = search_stack_low = __builtin_frame_address(0);
+    PROFILE_RESET();
+    TRACE_RESET();
+    PROFILE_BEGIN(PROFILE_SEARCH);
+    new_search_map(&transposition_table, board);
+    const int depth = max_depth < MAX_SEARCH_DEPTH ? max_depth : MAX_SEARCH_DEPTH; // search stack only holds MAX_PLY plies
+    if (time_limit_ms > 0 || search_node_limit > 0) {
+        move = iterative_deepening_search(board, player, depth, time_limit_ms, score);
+    } else {
+        search_aborted = false;
+        search_limited = false;
+        search_deadline = 0;
+        *score = search_root(board, player, depth, &move);
+        search_stats.reached_depth = depth;
+        search_stats.iteration_nodes[depth] = search_stats.nodes;
+        search_stats.iteration_us[depth] = elapsed_us(start_time, clock());
+    }
+    search_stats.time_us = elapsed_us(start_time, clock());
+    search_stats.stack_bytes = (uint32_t)(search_stack_base - search_stack_low);
+#ifdef ESP_PLATFORM
+    search_stats.stack_free_min = uxTaskGetStackHighWaterMark(NULL); // bytes on ESP-IDF
+    search_stats.heap_free = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    search_stats.heap_free_min = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+#endif
+    PROFILE_END(PROFILE_SEARCH);
     return move;
 }
 
-// Alpha beta search a Board state
-int minimax(const Board* board, const char player, int alpha, int beta, const int depth, int* move, const bool null) {
+// copy of the statistics of the last search
+SearchStats get_search_stats() {
+    return search_stats;
+}
+
+// effective branching factor: node growth between the last two iterations, or nodes^(1/depth) for a single search
+float effective_branching_factor(const SearchStats* stats) {
+    const int depth = stats->reached_depth;
+    if (depth <= 0) return 0;
+    if (depth >= 2 && stats->iteration_nodes[depth-1] > 0)
+        return (float)stats->iteration_nodes[depth] / (float)stats->iteration_nodes[depth-1];
+    return powf((float)stats->iteration_nodes[depth], 1.0f / (float)depth);
+}
+
+// prints search statistics to the console
+void print_search_stats(const SearchStats* stats) {
+    printf("time: %.3f\n", stats->time_us / 1e6);
+    printf("depth: %d\n", stats->reached_depth);
+    printf("nodes: %lu (quiescence %lu)\n", (unsigned long)stats->nodes, (unsigned long)stats->q_nodes);
+    printf("t_table probes: %lu hits: %lu cutoffs: %lu\n", (unsigned long)stats->t_t_probes,
+           (unsigned long)stats->t_t_hits, (unsigned long)stats->t_t_cutoffs);
+    printf("t_table stores: %lu overwrites: %lu\n", (unsigned long)stats->t_t_stores, (unsigned long)stats->t_t_overwrites);
+    printf("evaluations: %lu\n", (unsigned long)stats->evaluations);
+    printf("evaluation cache hits: %lu\n", (unsigned long)stats->eval_cache_hits);
+    printf("quiescent evaluations: %lu\n", (unsigned long)stats->q_evaluations);
+    printf("null pruning: %lu\n", (unsigned long)stats->null_prunes);
+    printf("cutoffs: %lu (first move %lu)\n", (unsigned long)stats->cutoffs, (unsigned long)stats->first_move_cutoffs);
+    printf("branching factor: %.2f\n", effective_branching_factor(stats));
+    if (stats->max_ply > 0)
+        printf("stack: %lu bytes to ply %d (%lu per ply, ~%lu at ply %d)\n", (unsigned long)stats->stack_bytes,
+               stats->max_ply, (unsigned long)(stats->stack_bytes / stats->max_ply),
+               (unsigned long)(stats->stack_bytes / stats->max_ply * MAX_PLY), MAX_PLY);
+#ifdef ESP_PLATFORM
+    printf("task stack high water: %lu bytes free\n", (unsigned long)stats->stack_free_min);
+    printf("heap free: %lu bytes, lowest since boot: %lu (%lu t_table entries)\n", (unsigned long)stats->heap_free,
+           (unsigned long)stats->heap_free_min, (unsigned long)(stats->heap_free_min / sizeof(data)));
+#endif
+}
+
+// Searches with increasing depth until max_depth or the time/node limit, returns the move of the deepest completed search
+int iterative_deepening_search(const Board* board, const char player, const int max_depth, const int time_limit_ms, int* score) {
+    int best_move = -1;
+    search_aborted = false;
+    search_limited = false; // depth 1 always completes so there is a move to play
+    search_deadline = 0;
+    for (int depth = 1; depth <= max_depth; depth++) {
+        int move = -1;
+        const uint32_t start_nodes = search_stats.nodes;
+        const clock_t start_time = clock();
+        // each iteration stores under a new age, the previous ones' entries give the first moves to search
+        if (depth > 1) new_search_map(&transposition_table, board);
+        score_age = transposition_table.age;
+        const int eval = search_root(board, player, depth, &move);
+        if (search_aborted) break;
+        best_move = move;
+        *score = eval;
+        search_stats.reached_depth = depth;
+        search_stats.iteration_nodes[depth] = search_stats.nodes - start_nodes;
+        search_stats.iteration_us[depth] = elapsed_us(start_time, clock());
+        if (depth == 1) {
+            if (time_limit_ms > 0) search_deadline = clock() + (clock_t)((long long)time_limit_ms * CLOCKS_PER_SEC / 1000);
+            search_limited = true;
+        }
+    }
+    search_limited = false;
+    search_deadline = 0;
+    score_age = 0;
+    return best_move;
+}
+
+// stores a search result in the transposition table and counts the store
+static void t_t_store(const uint32_t key, const int n_of_pieces, const int score, const int depth, const int best_move, const bool quiescence) {
+    PROFILE_BEGIN(PROFILE_T_T_STORE);
+    const PutResult result = put_map_key(&transposition_table, key, n_of_pieces, score, depth, best_move, quiescence);
+    PROFILE_END(PROFILE_T_T_STORE);
+    if (result != PUT_FULL) search_stats.t_t_stores++;
+    if (result == PUT_REPLACED) search_stats.t_t_overwrites++;
+}
+
+// counts an alpha beta cutoff by the i-th move searched
+static void count_cutoff(const int i) {
+    search_stats.cutoffs++;
+    if (i == 0) search_stats.first_move_cutoffs++;
+}
+
+// records the deepest ply and the lowest stack frame of the search
+#define TRACK_STACK(ply) do { \
+        const char* frame = __builtin_frame_address(0); \
+        if (frame < search_stack_low) search_stack_low = frame; \
+        if ((ply) > search_stats.max_ply) search_stats.max_ply = (ply); \
+    } while (0)
+
+// minimax without tracing
+static int minimax_node(const Board* board, const char player, int alpha, int beta, const int depth, const int ply, int* move, const bool null) {
+    search_stats.nodes++;
+    TRACK_STACK(ply);
+    if (out_of_time()) return 0;
     // query transposition table
-    const data* t_t_entry = get_map(&transposition_table, board); 
-    if (t_t_entry != NULL && t_t_entry->n_of_pieces == count1s(board->black) + count1s(board->white)) { // avoid collisions
+    PROFILE_BEGIN(PROFILE_T_T_PROBE);
+    const int n_of_pieces = count1s(board->black) + count1s(board->white);
+    int sym;
+    const uint32_t key = t_t_key(board, n_of_pieces, &sym);
+    const data* t_t_entry = get_map_key(&transposition_table, key);
+    PROFILE_END(PROFILE_T_T_PROBE);
+    TRACE_KEY(key);
+    search_stats.t_t_probes++;
+    if (is_score_entry(t_t_entry) && t_t_entry->n_of_pieces == n_of_pieces) { // avoid collisions
+        search_stats.t_t_hits++;
+        TRACE_FLAG(TRACE_T_T_HIT);
         if (t_t_entry->depth >= depth) { // t_table score is at least as good as required depth
-            lookups++;
+            search_stats.t_t_cutoffs++;
+            TRACE_FLAG(TRACE_T_T_CUTOFF);
             return t_t_entry->score;
         }
         // t_table score is at a lower depth -> lower/upper bound estimate
@@ -89,94 +347,153 @@ int minimax(const Board* board, const char player, int alpha, int beta, const in
             alpha = alpha > t_t_entry->score ? alpha : t_t_entry->score;
         else if (player == BLACK)
             beta = beta < t_t_entry->score ? beta : t_t_entry->score;
-        if (alpha > beta)
+        if (alpha > beta) {
+            TRACE_FLAG(TRACE_T_T_CUTOFF);
             return t_t_entry->score;
+        }
     }
     // check if position has winner
-    if (check_winner(board) != '\0') return (depth+1)*evaluate_board(board);
+    PROFILE_BEGIN(PROFILE_WIN_CHECK);
+    const char winner = check_winner(board);
+    PROFILE_END(PROFILE_WIN_CHECK);
+    if (winner != '\0') {
+        TRACE_FLAG(TRACE_LEAF);
+        return (depth+1)*evaluate_board(board);
+    }
     // horizon nodes: perform quiescence search or evaluation
     if (depth <= 0) {
-        const int score = do_quiescence && !null ? quiescence_search(board, player, alpha, beta, 10) : evaluate_board(board);
-        if (!null) put_map(&transposition_table, board, score, 0, -1, false); //, EXACT);
+        TRACE_FLAG(TRACE_LEAF);
+        int score;
+        if (do_quiescence && !null) {
+            PROFILE_BEGIN(PROFILE_QUIESCENCE);
+            score = quiescence_search(board, player, alpha, beta, QUIESCENCE_DEPTH, ply);
+            PROFILE_END(PROFILE_QUIESCENCE);
+        } else {
+            score = evaluate_board(board);
+        }
+        if (!null && !search_aborted) t_t_store(key, n_of_pieces, score, 0, -1, false);
         return score;
     }
     // search
-    int* next_moves = NULL;
+    SearchPly* frame = &search_stack[ply];
+    Board* next_board = &frame->board;
     int best_eval;
-    Board* next_board;
     int n_of_moves;
     if (player == WHITE) {
         best_eval = INT_MIN;
         if (!null && depth >= 2) { // null search
-            const int null_eval = minimax(board, BLACK, alpha, beta, depth-R, NULL, true);
+            const int null_eval = minimax(board, BLACK, alpha, beta, depth-R, ply+1, NULL, true);
+            if (search_aborted) return 0;
             alpha = alpha > null_eval ? alpha : null_eval; // max(alpha, null_eval)
             if (alpha >= beta) {
-                null_pruning++;
+                search_stats.null_prunes++;
+                TRACE_FLAG(TRACE_NULL_PRUNE);
                 return null_eval; // null move pruning
             }
         }
         // search next moves
-        n_of_moves = count_next_moves(board);
-        next_moves = malloc(sizeof(int) * n_of_moves);
-        find_next_moves(next_moves, n_of_moves, board, player, 0, t_t_entry != NULL ? t_t_entry->best_move : -1);
-        for (int i = 0; i < n_of_moves && next_moves[i] >= 0; i++) {
-            next_board = create_next_board(board, next_moves[i], WHITE);
-            const int eval = minimax(next_board, BLACK, alpha, beta, depth - 1, NULL, null);
-            free(next_board);
+        n_of_moves = find_next_moves(frame->moves, frame->scores, board, player, 0, t_t_entry != NULL ? inverse_transform_move(t_t_entry->best_move, sym) : -1);
+        TRACE_MOVES(n_of_moves);
+        for (int i = 0; i < n_of_moves; i++) {
+            *next_board = *board;
+            place_piece(next_board, frame->moves[i]%BOARD_SIZE, frame->moves[i]/BOARD_SIZE, WHITE);
+            TRACE_CHILD(frame->moves[i]);
+            const int eval = minimax(next_board, BLACK, alpha, beta, depth - 1, ply + 1, NULL, null);
+            if (search_aborted) return 0;
+            TRACE_SEARCHED(i + 1);
             if (eval > best_eval) {
                 best_eval = eval;
-                if (move != NULL) *move = next_moves[i];
+                TRACE_BEST(frame->moves[i]);
+                if (move != NULL) *move = frame->moves[i];
             }
             alpha = alpha > eval ? alpha : eval; // max(alpha, eval)
-            if (beta <= alpha) break; // alpha beta cutoff
+            if (beta <= alpha) { // alpha beta cutoff
+                count_cutoff(i);
+                TRACE_FLAG(TRACE_CUTOFF);
+                break;
+            }
         }
     } else { // player == BLACK
         best_eval = INT_MAX;
         if (!null && depth >= 2) { // null search
-            const int null_eval = minimax(board, WHITE, alpha, beta, depth-R, NULL, true);
+            const int null_eval = minimax(board, WHITE, alpha, beta, depth-R, ply+1, NULL, true);
+            if (search_aborted) return 0;
             beta = beta < null_eval ? beta : null_eval; // min(beta, null_eval)
             if (alpha >= beta) {
-                null_pruning++;
+                search_stats.null_prunes++;
+                TRACE_FLAG(TRACE_NULL_PRUNE);
                 return null_eval; // null move pruning
             }
         }
         // search next moves
-        n_of_moves = count_next_moves(board);
-        next_moves = malloc(sizeof(int) * n_of_moves);
-        find_next_moves(next_moves, n_of_moves, board, player, 0, t_t_entry != NULL ? t_t_entry->best_move : -1);
-        for (int i = 0; i < n_of_moves && next_moves[i] >= 0; i++) {
-            next_board = create_next_board(board, next_moves[i], BLACK);
-            const int eval = minimax(next_board, WHITE, alpha, beta, depth - 1, NULL, null);
-            free(next_board);
+        n_of_moves = find_next_moves(frame->moves, frame->scores, board, player, 0, t_t_entry != NULL ? inverse_transform_move(t_t_entry->best_move, sym) : -1);
+        TRACE_MOVES(n_of_moves);
+        for (int i = 0; i < n_of_moves; i++) {
+            *next_board = *board;
+            place_piece(next_board, frame->moves[i]%BOARD_SIZE, frame->moves[i]/BOARD_SIZE, BLACK);
+            TRACE_CHILD(frame->moves[i]);
+            const int eval = minimax(next_board, WHITE, alpha, beta, depth - 1, ply + 1, NULL, null);
+            if (search_aborted) return 0;
+            TRACE_SEARCHED(i + 1);
             if (eval < best_eval) {
                 best_eval = eval;
-                if (move != NULL) *move = next_moves[i];
+                TRACE_BEST(frame->moves[i]);
+                if (move != NULL) *move = frame->moves[i];
             }
             beta = beta < eval ? beta : eval; // min(beta, eval)
-            if (beta <= alpha) break; // alpha beta cutoff
+            if (beta <= alpha) { // alpha beta cutoff
+                count_cutoff(i);
+                TRACE_FLAG(TRACE_CUTOFF);
+                break;
+            }
         }
     }
-    if (!null) put_map(&transposition_table, board, best_eval, depth, move == NULL ? -1 : *move, false); //, EXACT);
-    free(next_moves);
+    if (!null) t_t_store(key, n_of_pieces, best_eval, depth, move == NULL ? -1 : transform_move(*move, sym), false);
     return best_eval;
 }
 
-// perform a quiescence search in a Board state
-int quiescence_search(const Board* board, const char player, int alpha, int beta, const int depth) {
+// Alpha beta search a Board state
+int minimax(const Board* board, const char player, const int alpha, const int beta, const int depth, const int ply, int* move, const bool null) {
+    TRACE_ENTER(alpha, beta, depth, ply, null ? TRACE_NULL : 0);
+    const int score = minimax_node(board, player, alpha, beta, depth, ply, move, null);
+    TRACE_EXIT(score);
+    return score;
+}
+
+// quiescence_search without tracing
+static int quiescence_node(const Board* board, const char player, int alpha, int beta, const int depth, const int ply) {
+    search_stats.nodes++;
+    search_stats.q_nodes++;
+    TRACK_STACK(ply);
+    if (out_of_time()) return 0;
     // query transposition table
-    const data* t_t_entry = get_map(&transposition_table, board);
-    if (t_t_entry != NULL) {
-        lookups++;
+    PROFILE_BEGIN(PROFILE_T_T_PROBE);
+    const int n_of_pieces = count1s(board->black) + count1s(board->white);
+    int sym;
+    const uint32_t key = t_t_key(board, n_of_pieces, &sym);
+    const data* t_t_entry = get_map_key(&transposition_table, key);
+    PROFILE_END(PROFILE_T_T_PROBE);
+    TRACE_KEY(key);
+    search_stats.t_t_probes++;
+    if (is_score_entry(t_t_entry)) {
+        search_stats.t_t_hits++;
+        search_stats.t_t_cutoffs++;
+        TRACE_FLAG(TRACE_T_T_HIT | TRACE_T_T_CUTOFF);
         return t_t_entry->score;
     }
     int best_eval = evaluate_board(board);
-    if (depth < 10) q_evaluations++; 
-    if (depth <= 0) return best_eval; // max depth
+    if (depth < QUIESCENCE_DEPTH) search_stats.q_evaluations++;
+    if (depth <= 0) { // max depth
+        TRACE_FLAG(TRACE_LEAF);
+        return best_eval;
+    }
 
-    Board* next_board;
+    SearchPly* frame = &search_stack[ply];
+    Board* next_board = &frame->board;
     int best_move = -1;
     if (player == WHITE) {
-        if (best_eval >= beta) {
+        if (best_eval >= beta) { // stand pat
+            TRACE_FLAG(TRACE_LEAF);
             return best_eval;
         }
         // if (best_eval + DELTA < alpha) {
@@ -186,28 +503,34 @@ int quiescence_search(const Board* board, const char player, int alpha, int beta
         alpha = best_eval > alpha ? best_eval : alpha; // max(alpha, best_eval)
 
         // search next moves that score >= 1000
-        const int n_of_moves = count_next_moves(board);
-        int* next_moves = malloc(sizeof(int) * n_of_moves);
-        find_next_moves(next_moves, n_of_moves, board, player, 1000, -1);
-        if (next_moves[0] == -1) {
-            free(next_moves);
+        const int n_of_moves = find_next_moves(frame->moves, frame->scores, board, player, 1000, -1);
+        TRACE_MOVES(n_of_moves);
+        if (n_of_moves == 0) {
+            TRACE_FLAG(TRACE_LEAF);
             return best_eval;
         }
-        for (int i = 0; i < n_of_moves && next_moves[i] >= 0; i++) {
-            next_board = create_next_board(board, next_moves[i], WHITE);
-            const int eval = quiescence_search(next_board, BLACK, alpha, beta, depth - 1);
-            free(next_board);
+        for (int i = 0; i < n_of_moves; i++) {
+            *next_board = *board;
+            place_piece(next_board, frame->moves[i]%BOARD_SIZE, frame->moves[i]/BOARD_SIZE, WHITE);
+            TRACE_CHILD(frame->moves[i]);
+            const int eval = quiescence_search(next_board, BLACK, alpha, beta, depth - 1, ply + 1);
+            if (search_aborted) return 0;
+            TRACE_SEARCHED(i + 1);
 
             if(eval > best_eval) {
                 best_eval = eval;
-                best_move = next_moves[i];
+                best_move = frame->moves[i];
+                TRACE_BEST(best_move);
+            }
+            if(best_eval >= beta) {
+                TRACE_FLAG(TRACE_CUTOFF);
+                break;
             }
-            if(best_eval >= beta) break;
             if(eval > alpha) alpha = eval;
         }
-        free(next_moves);
     } else { // player == BLACK
-        if (best_eval <= alpha) {
+        if (best_eval <= alpha) { // stand pat
+            TRACE_FLAG(TRACE_LEAF);
             return best_eval;
         }
         // if (best_eval - DELTA > beta) {
@@ -217,34 +540,358 @@ int quiescence_search(const Board* board, const char player, int alpha, int beta
         beta = best_eval < beta ? best_eval : beta; // min(beta, best_eval)
 
         // search next moves that score >= 1000
-        const int n_of_moves = count_next_moves(board);
-        int* next_moves = malloc(sizeof(int) * n_of_moves);
-        find_next_moves(next_moves, n_of_moves, board, player, 1000, -1);
-        if (next_moves[0] == -1) {
-            free(next_moves);
+        const int n_of_moves = find_next_moves(frame->moves, frame->scores, board, player, 1000, -1);
+        TRACE_MOVES(n_of_moves);
+        if (n_of_moves == 0) {
+            TRACE_FLAG(TRACE_LEAF);
             return best_eval;
         }
-        for (int i = 0; i < n_of_moves && next_moves[i] >= 0; i++) {
-            next_board = create_next_board(board, next_moves[i], BLACK);
-            const int eval = quiescence_search(next_board, WHITE, alpha, beta, depth - 1);
-            free(next_board);
+        for (int i = 0; i < n_of_moves; i++) {
+            *next_board = *board;
+            place_piece(next_board, frame->moves[i]%BOARD_SIZE, frame->moves[i]/BOARD_SIZE, BLACK);
+            TRACE_CHILD(frame->moves[i]);
+            const int eval = quiescence_search(next_board, WHITE, alpha, beta, depth - 1, ply + 1);
+            if (search_aborted) return 0;
+            TRACE_SEARCHED(i + 1);
 
             if(eval < best_eval) {
                 best_eval = eval;
-                best_move = next_moves[i];
+                best_move = frame->moves[i];
+                TRACE_BEST(best_move);
+            }
+            if(best_eval <= alpha) {
+                TRACE_FLAG(TRACE_CUTOFF);
+                break;
             }
-            if(best_eval <= alpha) break;
             if(eval < beta) beta = eval;
         }
-        free(next_moves);
     }
-    put_map(&transposition_table, board, best_eval, 0, best_move, true); //, EXACT);
+    t_t_store(key, n_of_pieces, best_eval, 0, transform_move(best_move, sym), true);
     return best_eval;
 }
 
-// gives a score to a board state (+ for white, - for black)
+// perform a quiescence search in a Board state
+int quiescence_search(const Board* board, const char player, const int alpha, const int beta, const int depth, const int ply) {
+    TRACE_ENTER(alpha, beta, depth, ply, TRACE_QUIESCENCE);
+    const int score = quiescence_node(board, player, alpha, beta, depth, ply);
+    TRACE_EXIT(score);
+    return score;
+}
+
+// explicit stack search: the same nodes as minimax/quiescence_search in the same order, but the state of
+// every node lives in the preallocated node stack, so the C stack use doesn't depend on the depth and the
+// search can be suspended before any node and resumed later
+
+static void push_node(const uint8_t kind, const Board* board, const char player, const int alpha, const int beta,
+                      const int depth, const int ply, const bool null, int* move) {
+    search_nodes[++search_top] = (SearchNode){.board = board, .move = move, .alpha = alpha, .beta = beta,
+        .depth = depth, .ply = ply, .player = player, .kind = kind, .stage = STAGE_ENTER, .null = null};
+    TRACE_ENTER(alpha, beta, depth, ply, kind == NODE_QUIESCENCE ? TRACE_QUIESCENCE : null ? TRACE_NULL : 0);
+}
+
+// pushes the child of the next move, or returns false when all moves were searched
+static bool push_next_move(SearchNode* node) {
+    if (node->i >= node->n_of_moves) return false;
+    SearchPly* frame = &search_stack[node->ply];
+    frame->board = *node->board;
+    place_piece(&frame->board, frame->moves[node->i]%BOARD_SIZE, frame->moves[node->i]/BOARD_SIZE, node->player);
+    TRACE_CHILD(frame->moves[node->i]);
+    push_node(node->kind, &frame->board, node->player == WHITE ? BLACK : WHITE, node->alpha, node->beta,
+              node->depth - 1, node->ply + 1, node->null, NULL);
+    return true;
+}
+
+// minimax_node as a state machine: returns true when a child was pushed, false when the node returned *value
+// (on resume *value holds the result of the child)
+static bool step_minimax(SearchNode* node, int* value) {
+    const Board* board = node->board;
+    const int ply = node->ply;
+    switch (node->stage) {
+        case STAGE_ENTER: {
+            search_stats.nodes++;
+            TRACK_STACK(ply);
+            if (out_of_time()) {
+                *value = 0;
+                return false;
+            }
+            // query transposition table
+            PROFILE_BEGIN(PROFILE_T_T_PROBE);
+            node->n_of_pieces = count1s(board->black) + count1s(board->white);
+            node->key = t_t_key(board, node->n_of_pieces, &node->sym);
+            node->t_t_entry = get_map_key(&transposition_table, node->key);
+            PROFILE_END(PROFILE_T_T_PROBE);
+            TRACE_KEY(node->key);
+            search_stats.t_t_probes++;
+            const data* t_t_entry = node->t_t_entry;
+            if (is_score_entry(t_t_entry) && t_t_entry->n_of_pieces == node->n_of_pieces) { // avoid collisions
+                search_stats.t_t_hits++;
+                TRACE_FLAG(TRACE_T_T_HIT);
+                if (t_t_entry->depth >= node->depth) { // t_table score is at least as good as required depth
+                    search_stats.t_t_cutoffs++;
+                    TRACE_FLAG(TRACE_T_T_CUTOFF);
+                    *value = t_t_entry->score;
+                    return false;
+                }
+                // t_table score is at a lower depth -> lower/upper bound estimate
+                if (node->player == WHITE)
+                    node->alpha = node->alpha > t_t_entry->score ? node->alpha : t_t_entry->score;
+                else if (node->player == BLACK)
+                    node->beta = node->beta < t_t_entry->score ? node->beta : t_t_entry->score;
+                if (node->alpha > node->beta) {
+                    TRACE_FLAG(TRACE_T_T_CUTOFF);
+                    *value = t_t_entry->score;
+                    return false;
+                }
+            }
+            // check if position has winner
+            PROFILE_BEGIN(PROFILE_WIN_CHECK);
+            const char winner = check_winner(board);
+            PROFILE_END(PROFILE_WIN_CHECK);
+            if (winner != '\0') {
+                TRACE_FLAG(TRACE_LEAF);
+                *value = (node->depth+1)*evaluate_board(board);
+                return false;
+            }
+            // horizon nodes: perform quiescence search or evaluation
+            if (node->depth <= 0) {
+                TRACE_FLAG(TRACE_LEAF);
+                if (do_quiescence && !node->null) {
+                    PROFILE_START(node->profile_start);
+                    node->stage = STAGE_HORIZON;
+                    push_node(NODE_QUIESCENCE, board, node->player, node->alpha, node->beta, QUIESCENCE_DEPTH, ply, false, NULL);
+                    return true;
+                }
+                *value = evaluate_board(board);
+                if (!node->null && !search_aborted) t_t_store(node->key, node->n_of_pieces, *value, 0, -1, false);
+                return false;
+            }
+            node->best_eval = node->player == WHITE ? INT_MIN : INT_MAX;
+            if (!node->null && node->depth >= 2) { // null search
+                node->stage = STAGE_NULL;
+                push_node(NODE_MINIMAX, board, node->player == WHITE ? BLACK : WHITE, node->alpha, node->beta,
+                          node->depth-R, ply+1, true, NULL);
+                return true;
+            }
+            break; // search next moves
+        }
+        case STAGE_HORIZON:
+            PROFILE_STOP(PROFILE_QUIESCENCE, node->profile_start);
+            if (!node->null && !search_aborted) t_t_store(node->key, node->n_of_pieces, *value, 0, -1, false);
+            return false;
+        case STAGE_NULL: {
+            if (search_aborted) {
+                *value = 0;
+                return false;
+            }
+            const int null_eval = *value;
+            if (node->player == WHITE) node->alpha = node->alpha > null_eval ? node->alpha : null_eval; // max(alpha, null_eval)
+            else node->beta = node->beta < null_eval ? node->beta : null_eval; // min(beta, null_eval)
+            if (node->alpha >= node->beta) {
+                search_stats.null_prunes++;
+                TRACE_FLAG(TRACE_NULL_PRUNE);
+                return false; // null move pruning
+            }
+            break; // search next moves
+        }
+        default: { // STAGE_MOVES
+            if (search_aborted) {
+                *value = 0;
+                return false;
+            }
+            const int eval = *value;
+            const int move = search_stack[ply].moves[node->i];
+            TRACE_SEARCHED(node->i + 1);
+            bool cutoff;
+            if (node->player == WHITE) {
+                if (eval > node->best_eval) {
+                    node->best_eval = eval;
+                    TRACE_BEST(move);
+                    if (node->move != NULL) *node->move = move;
+                }
+                node->alpha = node->alpha > eval ? node->alpha : eval; // max(alpha, eval)
+            } else {
+                if (eval < node->best_eval) {
+                    node->best_eval = eval;
+                    TRACE_BEST(move);
+                    if (node->move != NULL) *node->move = move;
+                }
+                node->beta = node->beta < eval ? node->beta : eval; // min(beta, eval)
+            }
+            cutoff = node->beta <= node->alpha;
+            if (cutoff) { // alpha beta cutoff
+                count_cutoff(node->i);
+                TRACE_FLAG(TRACE_CUTOFF);
+            } else {
+                node->i++;
+                if (push_next_move(node)) return true;
+            }
+            if (!node->null)
+                t_t_store(node->key, node->n_of_pieces, node->best_eval, node->depth,
+                          node->move == NULL ? -1 : transform_move(*node->move, node->sym), false);
+            *value = node->best_eval;
+            return false;
+        }
+    }
+    // search next moves
+    SearchPly* frame = &search_stack[ply];
+    node->n_of_moves = find_next_moves(frame->moves, frame->scores, board, node->player, 0,
+                                       node->t_t_entry != NULL ? inverse_transform_move(node->t_t_entry->best_move, node->sym) : -1);
+    TRACE_MOVES(node->n_of_moves);
+    node->i = 0;
+    node->stage = STAGE_MOVES;
+    if (push_next_move(node)) return true;
+    if (!node->null)
+        t_t_store(node->key, node->n_of_pieces, node->best_eval, node->depth,
+                  node->move == NULL ? -1 : transform_move(*node->move, node->sym), false);
+    *value = node->best_eval;
+    return false;
+}
+
+// quiescence_node as a state machine, same protocol as step_minimax
+static bool step_quiescence(SearchNode* node, int* value) {
+    const Board* board = node->board;
+    if (node->stage == STAGE_ENTER) {
+        search_stats.nodes++;
+        search_stats.q_nodes++;
+        TRACK_STACK(node->ply);
+        if (out_of_time()) {
+            *value = 0;
+            return false;
+        }
+        // query transposition table
+        PROFILE_BEGIN(PROFILE_T_T_PROBE);
+        node->n_of_pieces = count1s(board->black) + count1s(board->white);
+        node->key = t_t_key(board, node->n_of_pieces, &node->sym);
+        const data* t_t_entry = get_map_key(&transposition_table, node->key);
+        PROFILE_END(PROFILE_T_T_PROBE);
+        TRACE_KEY(node->key);
+        search_stats.t_t_probes++;
+        if (is_score_entry(t_t_entry)) {
+            search_stats.t_t_hits++;
+            search_stats.t_t_cutoffs++;
+            TRACE_FLAG(TRACE_T_T_HIT | TRACE_T_T_CUTOFF);
+            *value = t_t_entry->score;
+            return false;
+        }
+        node->best_eval = evaluate_board(board);
+        if (node->depth < QUIESCENCE_DEPTH) search_stats.q_evaluations++;
+        if (node->depth <= 0) { // max depth
+            TRACE_FLAG(TRACE_LEAF);
+            *value = node->best_eval;
+            return false;
+        }
+        // stand pat
+        if (node->player == WHITE ? node->best_eval >= node->beta : node->best_eval <= node->alpha) {
+            TRACE_FLAG(TRACE_LEAF);
+            *value = node->best_eval;
+            return false;
+        }
+        if (node->player == WHITE) node->alpha = node->best_eval > node->alpha ? node->best_eval : node->alpha; // max(alpha, best_eval)
+        else node->beta = node->best_eval < node->beta ? node->best_eval : node->beta; // min(beta, best_eval)
+
+        // search next moves that score >= 1000
+        SearchPly* frame = &search_stack[node->ply];
+        node->n_of_moves = find_next_moves(frame->moves, frame->scores, board, node->player, 1000, -1);
+        TRACE_MOVES(node->n_of_moves);
+        if (node->n_of_moves == 0) {
+            TRACE_FLAG(TRACE_LEAF);
+            *value = node->best_eval;
+            return false;
+        }
+        node->best_move = -1;
+        node->i = 0;
+        node->stage = STAGE_MOVES;
+        push_next_move(node);
+        return true;
+    }
+    // STAGE_MOVES
+    if (search_aborted) {
+        *value = 0;
+        return false;
+    }
+    const int eval = *value;
+    const int move = search_stack[node->ply].moves[node->i];
+    TRACE_SEARCHED(node->i + 1);
+    bool cutoff;
+    if (node->player == WHITE) {
+        if (eval > node->best_eval) {
+            node->best_eval = eval;
+            node->best_move = move;
+            TRACE_BEST(move);
+        }
+        cutoff = node->best_eval >= node->beta;
+        if (!cutoff && eval > node->alpha) node->alpha = eval;
+    } else {
+        if (eval < node->best_eval) {
+            node->best_eval = eval;
+            node->best_move = move;
+            TRACE_BEST(move);
+        }
+        cutoff = node->best_eval <= node->alpha;
+        if (!cutoff && eval < node->beta) node->beta = eval;
+    }
+    if (cutoff) {
+        TRACE_FLAG(TRACE_CUTOFF);
+    } else {
+        node->i++;
+        if (push_next_move(node)) return true;
+    }
+    t_t_store(node->key, node->n_of_pieces, node->best_eval, 0, transform_move(node->best_move, node->sym), true);
+    *value = node->best_eval;
+    return false;
+}
+
+// starts an explicit stack search of a Board state (move must stay valid until the search finished)
+void start_iterative_search(const Board* board, const char player, const int alpha, const int beta, const int depth, int* move) {
+    search_top = -1;
+    push_node(NODE_MINIMAX, board, player, alpha, beta, depth, 0, false, move);
+}
+
+// runs the started search for up to max_nodes nodes (0 = no limit), returns true when it finished
+bool run_iterative_search(const uint32_t max_nodes) {
+    const uint32_t start_nodes = search_stats.nodes;
+    while (search_top >= 0) {
+        SearchNode* node = &search_nodes[search_top];
+        if (node->stage == STAGE_ENTER && max_nodes != 0 && search_stats.nodes - start_nodes >= max_nodes)
+            return false; // suspend before the node
+        if (node->kind == NODE_MINIMAX ? step_minimax(node, &search_value) : step_quiescence(node, &search_value))
+            continue;
+        TRACE_EXIT(search_value);
+        search_top--;
+    }
+    return true;
+}
+
+// result of the finished search
+int iterative_search_result() {
+    return search_value;
+}
+
+// minimax from the root with the explicit stack search, yielding between slices when set_search_yield is set
+int iterative_minimax(const Board* board, const char player, const int alpha, const int beta, const int depth, int* move) {
+    start_iterative_search(board, player, alpha, beta, depth, move);
+    while (!run_iterative_search(search_yield != NULL ? search_slice_nodes : 0)) search_yield();
+    return iterative_search_result();
+}
+
+// gives a score to a board state (+ for white, - for black), using the evaluation cache
 int evaluate_board(const Board* board) {
-    evaluations++;
+    PROFILE_BEGIN(PROFILE_EVALUATION);
+    const uint32_t key = hash_board(board), check = check_hash_board(board);
+    int score;
+    if (get_eval_cache(&eval_cache, key, check, &score)) {
+        search_stats.eval_cache_hits++;
+    } else {
+        score = static_evaluation(board);
+        put_eval_cache(&eval_cache, key, check, score);
+    }
+    PROFILE_END(PROFILE_EVALUATION);
+    return score;
+}
+
+// computes the score of a board state by counting its sequences
+int static_evaluation(const Board* board) {
+    search_stats.evaluations++;
     init_eval(board);
     // check if game is over
     const char winner = check_winner(board);
@@ -298,16 +945,12 @@ int count_next_moves(const Board* board) {
     return next_moves;
 }
 
-// find all possible next moves, sorts by move score, filters out bad moves
-void find_next_moves(int* next_moves, const int n_of_moves, const Board* board, const char player, const int threshold, const int best_move) {
-    if (next_moves == NULL) return;
-    int scores[BOARD_SIZE*BOARD_SIZE]; // score for each board position (only fill possible moves)
+// find_next_moves without profiling
+static int generate_next_moves(int* next_moves, int* scores, const Board* board, const char player, const int threshold, const int best_move) {
+    if (next_moves == NULL) return 0;
     if (is_board_empty(board)) { // if board is empty play randomly
-        next_moves[0] = rand() % (BOARD_SIZE*BOARD_SIZE);
-        return;
-    }
-    for (int i = 0; i < n_of_moves; i++) {
-        next_moves[i] = -1;
+        next_moves[0] = random32() % (BOARD_SIZE*BOARD_SIZE);
+        return 1;
     }
     int count = 0;
     for (int i = 0; i < BOARD_SIZE; i++) {
@@ -325,12 +968,13 @@ void find_next_moves(int* next_moves, const int n_of_moves, const Board* board,
             }
         }
     }
-    // removes moves 90 times worse then best move
+    if (count == 0) return 0;
+    // removes moves 90 times worse then best move (moves are sorted so cut at the first one)
     const int threshold_score = scores[next_moves[0]]/90;
-    for (int i = 0; i < n_of_moves; i++) {
-        if (next_moves[i] < -1 || next_moves[i] > BOARD_SIZE*BOARD_SIZE || scores[next_moves[i]] < threshold_score) {
-            next_moves[i] = -1;
+    for (int i = 0; i < count; i++) {
+        if (scores[next_moves[i]] < threshold_score) {
             count = i;
+            break;
         }
     }
     if (best_move != -1) { // put best move from transposition table first
@@ -344,10 +988,21 @@ void find_next_moves(int* next_moves, const int n_of_moves, const Board* board,
             }
         }
     }
+    return count;
+}
+
+// find all possible next moves, sorts by move score, filters out bad moves
+// next_moves and scores must hold MAX_MOVES entries, returns the number of moves found
+int find_next_moves(int* next_moves, int* scores, const Board* board, const char player, const int threshold, const int best_move) {
+    PROFILE_BEGIN(PROFILE_MOVE_GENERATION);
+    const int count = generate_next_moves(next_moves, scores, board, player, threshold, best_move);
+    PROFILE_END(PROFILE_MOVE_GENERATION);
+    return count;
 }
 
 // gives a score to a potential move
 int evaluate_move(const Board* board, const int x, const int y, const char player) {
+    PROFILE_BEGIN(PROFILE_MOVE_SCORING);
     int score = 0;
     const char enemy = player == WHITE ? BLACK : WHITE;
     int sequences[8] = {0, 0, 0, 0, 0, 0, 0, 0}; // NW, N, NE, W, E, SW, S, SE
@@ -521,15 +1176,25 @@ int evaluate_move(const Board* board, const int x, const int y, const char playe
         }
         score += temp;
     }
+    PROFILE_END(PROFILE_MOVE_SCORING);
     return score;
 }
 
+// forgets everything searched so far (transposition table and evaluation cache)
+void clear_bot() {
+    empty_map(&transposition_table);
+    empty_eval_cache(&eval_cache);
+}
+
 // restarts the bot for a new game
 void reset_bot() {
-    empty_map(&transposition_table);
+    new_game_map(&transposition_table);
 }
 
 // free allocated resources
 void free_bot() {
     free_map(&transposition_table);
+    free_eval_cache(&eval_cache);
+    free(search_stack);
+    free(search_nodes);
 }
@@ -8,28 +8,92 @@
 
 #include <stdbool.h>
 #include <limits.h>
-#include "board.h"
+#include "Board.h"
+#include "hashmap.h"
 
 #define N_OF_CHECKS 10
 #define FUTILITY_MARGIN 100
 #define R 3
 // #define DELTA 1000
+#define MAX_SEARCH_DEPTH 9 // deepest search the app can request (search depth characteristic accepts < 10)
+#define QUIESCENCE_DEPTH 10 // max extra plies searched by quiescence search
+#define MAX_PLY (MAX_SEARCH_DEPTH + QUIESCENCE_DEPTH + 1) // deepest ply the search can reach
+#define MAX_MOVES (BOARD_SIZE*BOARD_SIZE) // at most one move per cell
+#define CANONICAL_MAX_PIECES 8 // positions with up to this many pieces share table entries with their symmetries
+#define EVAL_CACHE_CAP 4096 // entries in the static evaluation cache (power of 2, 12 bytes each)
+
+// preallocated state for one ply of the search
+typedef struct SearchPly {
+    int moves[MAX_MOVES];  // next moves generated at this ply
+    int scores[MAX_MOVES]; // move scores (indexed by board position)
+    Board board;           // board of the move being searched from this ply
+} SearchPly;
+
+// statistics of a search, reset by every bot_search
+typedef struct SearchStats {
+    uint32_t nodes;              // minimax and quiescence nodes
+    uint32_t q_nodes;            // quiescence nodes
+    uint32_t t_t_probes;         // transposition table queries
+    uint32_t t_t_hits;           // queries that found the position
+    uint32_t t_t_cutoffs;        // hits deep enough to return their score
+    uint32_t t_t_stores;         // entries written (new, updated or replaced)
+    uint32_t t_t_overwrites;     // stores that replaced another position
+    uint32_t evaluations;        // static evaluations
+    uint32_t eval_cache_hits;    // evaluations answered by the evaluation cache
+    uint32_t q_evaluations;      // evaluations inside quiescence search
+    uint32_t null_prunes;        // null move prunes
+    uint32_t cutoffs;            // alpha beta cutoffs in minimax
+    uint32_t first_move_cutoffs; // cutoffs by the first move searched (move ordering quality)
+    uint32_t time_us;            // whole search
+    uint32_t iteration_nodes[MAX_SEARCH_DEPTH + 1]; // nodes of each completed depth (index = depth)
+    uint32_t iteration_us[MAX_SEARCH_DEPTH + 1];    // time of each completed depth
+    int reached_depth;           // deepest completed depth
+    int max_ply;                 // deepest ply visited, quiescence included
+    uint32_t stack_bytes;        // stack from bot_search to the deepest node frame (leaf calls not included)
+    uint32_t stack_free_min;     // least stack the task ever had left, in bytes (device only)
+    uint32_t heap_free;          // free heap after the search (device only)
+    uint32_t heap_free_min;      // least free heap since boot (device only)
+} SearchStats;
+
+extern Map transposition_table;
+
+extern SearchStats search_stats;
 
 void init_bot(int t_t_cap);
 
-int minimax(const Board* board, char player, int alpha, int beta, int depth, int* move, bool null);
+int minimax(const Board* board, char player, int alpha, int beta, int depth, int ply, int* move, bool null);
 
-int quiescence_search(const Board* board, char player, int alpha, int beta, int depth);
+int quiescence_search(const Board* board, char player, int alpha, int beta, int depth, int ply);
+
+void start_iterative_search(const Board* board, char player, int alpha, int beta, int depth, int* move);
+
+bool run_iterative_search(uint32_t max_nodes);
+
+int iterative_search_result();
+
+int iterative_minimax(const Board* board, char player, int alpha, int beta, int depth, int* move);
 
 int bot_place_piece(const Board* board, char player, int max_depth);
 
+int bot_search(const Board* board, char player, int max_depth, int time_limit_ms, int* score);
+
+SearchStats get_search_stats();
+
+float effective_branching_factor(const SearchStats* stats);
+
+void print_search_stats(const SearchStats* stats);
+
+int iterative_deepening_search(const Board* board, char player, int max_depth, int time_limit_ms, int* score);
+
 int evaluate_board(const Board* board);
 
+int static_evaluation(const Board* board);
+
 bool is_next_position(const Board* board, int x, int y);
 
 int count_next_moves(const Board* board);
 
-void find_next_moves(int* next_moves, int n_of_moves, const Board* board, char player, int threshold, int best_move);
+int find_next_moves(int* next_moves, int* scores, const Board* board, char player, int threshold, int best_move);
 
 int evaluate_move(const Board* board, int x, int y, char player);
 
@@ -37,8 +101,24 @@ void set_do_quiescence(bool new);
 
 void set_better_move_order(bool new);
 
+void set_canonical_t_t(bool new);
+
+void set_iterative_search(bool new);
+
+void set_search_yield(void (*yield)(), uint32_t slice_nodes);
+
+void set_node_limit(int node_limit);
+
+void set_search_cancelled(bool cancelled);
+
+bool is_search_cancelled();
+
+Map bot_swap_table(Map table);
+
 void reset_bot();
 
+void clear_bot();
+
 void free_bot();
 
 #endif //BOT_H
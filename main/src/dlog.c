@@ -0,0 +1,99 @@
+//
+// dlog.c
+// Developed by the GAME2 Team.
+// Ring buffer and printing task of the deferred log (device only, the host prints directly).
+//
+#ifdef ESP_PLATFORM
+#include <string.h>
+
+#include "dlog.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define DLOG_TASK_STACK      3072
+#define DLOG_TASK_PRIORITY   1  // just above idle, printing never delays the game
+#define DLOG_DRAIN_PERIOD_MS 20
+
+typedef struct DlogRecord {
+    const void* format; // format string or dlog_formatter_t
+    const char* tag;
+    uint32_t time_ms;
+    uint8_t level;
+    uint8_t is_formatter;
+    uint8_t n_of_args;
+    uint32_t args[DLOG_MAX_ARGS];
+} DlogRecord;
+
+_Static_assert((DLOG_RING_RECORDS & (DLOG_RING_RECORDS - 1)) == 0, "DLOG_RING_RECORDS must be a power of 2");
+
+static DlogRecord ring[DLOG_RING_RECORDS];
+static uint32_t head = 0, tail = 0; // free running, records head - tail are waiting
+static uint32_t dropped = 0;        // records lost because the ring was full (the newest are dropped)
+static portMUX_TYPE ring_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void dlog_write(const int level, const char* tag, const void* format, const int is_formatter, const int n_of_args,
+                const uint32_t* args) {
+    const uint32_t time_ms = esp_log_timestamp();
+    taskENTER_CRITICAL(&ring_lock);
+    if (head - tail == DLOG_RING_RECORDS) {
+        dropped++;
+    } else {
+        DlogRecord* record = &ring[head++ & (DLOG_RING_RECORDS - 1)];
+        record->format = format;
+        record->tag = tag;
+        record->time_ms = time_ms;
+        record->level = level;
+        record->is_formatter = is_formatter;
+        record->n_of_args = n_of_args;
+        memcpy(record->args, args, n_of_args * sizeof(uint32_t));
+    }
+    taskEXIT_CRITICAL(&ring_lock);
+}
+
+// takes the oldest record, returns false when the ring is empty
+static bool dlog_read(DlogRecord* record) {
+    taskENTER_CRITICAL(&ring_lock);
+    const bool found = head != tail;
+    if (found) *record = ring[tail++ & (DLOG_RING_RECORDS - 1)];
+    taskEXIT_CRITICAL(&ring_lock);
+    return found;
+}
+
+// records dropped since the last call
+static uint32_t dlog_take_dropped() {
+    taskENTER_CRITICAL(&ring_lock);
+    const uint32_t lost = dropped;
+    dropped = 0;
+    taskEXIT_CRITICAL(&ring_lock);
+    return lost;
+}
+
+// prints a record like ESP_LOG: level, time, tag, message
+static void dlog_print(const DlogRecord* record) {
+    static const char levels[] = "-EWID";
+    if (record->is_formatter) {
+        ((dlog_formatter_t)record->format)(record->args);
+        return;
+    }
+    printf("%c (%lu) %s: ", levels[record->level], (unsigned long)record->time_ms, record->tag);
+    const uint32_t* a = record->args; // unused arguments are ignored by printf
+    printf((const char*)record->format, a[0], a[1], a[2], a[3], a[4], a[5]);
+    putchar('\n');
+}
+
+static void dlog_task(void* param) {
+    DlogRecord record;
+    for (;;) {
+        while (dlog_read(&record)) dlog_print(&record);
+        const uint32_t lost = dlog_take_dropped(); // the newest records, after the ones printed
+        if (lost > 0) printf("W dlog: %lu log records dropped\n", (unsigned long)lost);
+        vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_PERIOD_MS));
+    }
+}
+
+void dlog_init() {
+    xTaskCreate(dlog_task, "dlog", DLOG_TASK_STACK, NULL, DLOG_TASK_PRIORITY, NULL);
+}
+
+#endif //ESP_PLATFORM
@@ -0,0 +1,90 @@
+//
+// dlog.h
+// Developed by the GAME2 Team.
+// Deferred logging for the move path: a log call only stores its format string pointer, tag and up to
+// DLOG_MAX_ARGS integer arguments in a ring buffer. A low priority task formats and prints them later,
+// so the UART doesn't slow down BLE, the search or the radio. On the host every call prints right away, to
+// stderr so it doesn't mix with the output of the tools (the line protocol of gomoku_game).
+// Calls above GOMOKU_LOG_LEVEL (CONFIG_GOMOKU_LOG_LEVEL on the device) compile to nothing.
+//
+// Formats and tags must be string literals, arguments int sized integers (%d %u %x %c, no %s or floats).
+//
+
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#if defined(CONFIG_GOMOKU_LOG_LEVEL) && !defined(GOMOKU_LOG_LEVEL)
+#define GOMOKU_LOG_LEVEL CONFIG_GOMOKU_LOG_LEVEL
+#define DLOG_RING_RECORDS CONFIG_GOMOKU_LOG_RECORDS
+#endif
+#endif
+
+#define DLOG_NONE  0
+#define DLOG_ERROR 1
+#define DLOG_WARN  2
+#define DLOG_INFO  3
+#define DLOG_DEBUG 4
+
+#ifndef GOMOKU_LOG_LEVEL
+#define GOMOKU_LOG_LEVEL DLOG_INFO
+#endif
+#ifndef DLOG_RING_RECORDS
+#define DLOG_RING_RECORDS 128 // power of 2
+#endif
+#define DLOG_MAX_ARGS 6
+
+// prints a record with its own code (board rows, ...), instead of a format string, to DLOG_STREAM
+typedef void (*dlog_formatter_t)(const uint32_t* args);
+
+#define DLOG_ARGS(...) ((const uint32_t[]){0, ##__VA_ARGS__})
+#define DLOG_N_OF_ARGS(...) (int)(sizeof(DLOG_ARGS(__VA_ARGS__)) / sizeof(uint32_t) - 1)
+#define DLOG_CHECK_ARGS(...) \
+    _Static_assert(sizeof(DLOG_ARGS(__VA_ARGS__)) <= (DLOG_MAX_ARGS + 1) * sizeof(uint32_t), "too many log arguments")
+
+#ifdef ESP_PLATFORM
+
+#define DLOG_STREAM stdout
+
+void dlog_write(int level, const char* tag, const void* format, int is_formatter, int n_of_args, const uint32_t* args);
+
+// starts the task printing the records
+void dlog_init();
+
+#define DLOG(level, tag, format, ...) do { \
+        DLOG_CHECK_ARGS(__VA_ARGS__); \
+        if ((level) <= GOMOKU_LOG_LEVEL) \
+            dlog_write(level, tag, format, 0, DLOG_N_OF_ARGS(__VA_ARGS__), &DLOG_ARGS(__VA_ARGS__)[1]); \
+    } while (0)
+#define DLOG_CALL(level, tag, formatter, ...) do { \
+        DLOG_CHECK_ARGS(__VA_ARGS__); \
+        if ((level) <= GOMOKU_LOG_LEVEL) \
+            dlog_write(level, tag, formatter, 1, DLOG_N_OF_ARGS(__VA_ARGS__), &DLOG_ARGS(__VA_ARGS__)[1]); \
+    } while (0)
+
+#else
+
+#define DLOG_STREAM stderr
+
+#define dlog_init()
+#define DLOG(level, tag, format, ...) do { \
+        DLOG_CHECK_ARGS(__VA_ARGS__); \
+        if ((level) <= GOMOKU_LOG_LEVEL) fprintf(stderr, "%s: " format "\n", tag, ##__VA_ARGS__); \
+    } while (0)
+#define DLOG_CALL(level, tag, formatter, ...) do { \
+        DLOG_CHECK_ARGS(__VA_ARGS__); \
+        if ((level) <= GOMOKU_LOG_LEVEL) formatter(&DLOG_ARGS(__VA_ARGS__)[1]); \
+    } while (0)
+
+#endif //ESP_PLATFORM
+
+#define DLOG_E(tag, format, ...) DLOG(DLOG_ERROR, tag, format, ##__VA_ARGS__)
+#define DLOG_W(tag, format, ...) DLOG(DLOG_WARN, tag, format, ##__VA_ARGS__)
+#define DLOG_I(tag, format, ...) DLOG(DLOG_INFO, tag, format, ##__VA_ARGS__)
+#define DLOG_D(tag, format, ...) DLOG(DLOG_DEBUG, tag, format, ##__VA_ARGS__)
+
+#endif //DLOG_H
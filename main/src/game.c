@@ -0,0 +1,345 @@
+//
+// game.c
+// Developed by the GAME2 Team.
+// Game core shared by every front end: requests are queued for the search task, which plays the bot's
+// moves, sends them to the PIC and tells the front ends.
+//
+#include <stdio.h>
+#include <string.h>
+
+#include "game.h"
+#include "dlog.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#define TAG "game"
+
+/* Search task */
+#define SEARCH_TASK_STACK 8192 // the explicit stack search doesn't grow with the depth
+#define SEARCH_TASK_PRIORITY 4 // below the NimBLE host task
+#define SEARCH_QUEUE_LEN 8
+#if CONFIG_FREERTOS_UNICORE
+#define SEARCH_TASK_CORE 0
+#define SEARCH_SLICE_NODES 2048 // nodes between yields, so the search shares the core with BLE
+#else
+#define SEARCH_TASK_CORE 1 // the BLE controller and the NimBLE host task run on core 0
+#endif
+
+// game requests, handled by the search task in the order they were written
+typedef enum GameRequestType {
+    REQUEST_BOARD,    // white bit board, the bot answers as black
+    REQUEST_MOVE,     // one white move of the move protocol
+    REQUEST_AUTOPLAY, // the bot moves for player
+    REQUEST_RESET,    // only wakes the search task, which restarts the board of a new game_id by itself
+} GameRequestType;
+
+typedef struct GameRequest {
+    GameRequestType type;
+    uint32_t game;              // game_id when written, requests of a game that was reset since are dropped
+    uint8_t seq, move;          // REQUEST_MOVE
+    char player;                // REQUEST_AUTOPLAY
+    uint16_t white[BOARD_SIZE]; // REQUEST_BOARD
+} GameRequest;
+
+static Board game_board; // only changed by the search task
+static QueueHandle_t game_requests;
+static volatile uint32_t game_id = 0; // incremented by every reset
+static uint32_t board_game = 0; // game_id of game_board, search task only
+static volatile bool handling = false; // the search task took a request off the queue
+static game_radio_send_t radio_send = NULL;
+static const GameTransport* transports[GAME_MAX_TRANSPORTS];
+static int n_of_transports = 0;
+
+static volatile uint8_t next_move = GAME_MOVE_NONE;
+static volatile uint8_t search_depth = 5;
+static volatile char winner = '\0';
+static volatile uint8_t safety_state = 0;
+static SearchStats last_search_stats; // statistics of the bot's last move
+static nrf_message_t radio_move = {.type = NRF_MSG_MOVE, .length = 1, .data = {GAME_MOVE_NONE}}; // last move sent to the PIC
+
+// move protocol: {seq, move} requests, the reply is {seq, bot move, winner}
+static uint8_t move_reply[3] = {0, GAME_MOVE_NONE, 0}; // last reply, sent again when a request repeats its seq
+static uint8_t move_last_seq; // seq of the last move request
+static bool move_seq_valid = false; // a move was requested since the last reset
+
+static void restart_game_board() {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        game_board.white[i] = 0; // the move protocol only sends the app's moves
+        game_board.black[i] = 0;
+    }
+    next_move = GAME_MOVE_NONE;
+    reset_bot();
+    DLOG_I(TAG, "board reset.");
+}
+
+// prints a board row from the deferred log (row, white bits, black bits), like print_board
+static void print_board_row(const uint32_t* args) {
+    if (args[0] == 0) {
+        fprintf(DLOG_STREAM, "   ");
+        for (int j = 0; j < BOARD_SIZE; j++) fprintf(DLOG_STREAM, " %2d ", j);
+        fprintf(DLOG_STREAM, "\n");
+    }
+    char line[4 * BOARD_SIZE + 8], *out = line + sprintf(line, "%2d ", (int)args[0]);
+    for (int j = 0; j < BOARD_SIZE; j++)
+        out += sprintf(out, "| %c ", args[2] >> (15 - j) & 1 ? BLACK : args[1] >> (15 - j) & 1 ? WHITE : EMPTY);
+    fprintf(DLOG_STREAM, "%s|\n", line);
+}
+
+// logs the board one row per record, instead of the hundred printf calls of print_board
+static void log_board(const Board* board) {
+    for (int i = 0; i < BOARD_SIZE; i++)
+        DLOG_CALL(DLOG_INFO, TAG, print_board_row, i, board->white[i], board->black[i]);
+}
+
+// ends the game when someone won or the board is full
+static bool check_game_winner() {
+    const char w = check_winner(&game_board);
+    DLOG_D(TAG, "winner: %c", w);
+    if (w == '\0') return false; // game keeps going
+    winner = w;
+    restart_game_board();
+    return true;
+}
+
+// queues a request for the search task
+static GameResult submit_request(GameRequest* request) {
+    request->game = game_id;
+    if (xQueueSend(game_requests, request, 0) != pdTRUE) {
+        DLOG_E(TAG, "search queue full, request %d dropped", request->type);
+        return GAME_FULL;
+    }
+    return GAME_OK;
+}
+
+static void notify_bot_moved(const uint8_t move) {
+    for (int i = 0; i < n_of_transports; i++)
+        if (transports[i]->bot_moved != NULL) transports[i]->bot_moved(move);
+}
+
+static void notify_move_reply() {
+    for (int i = 0; i < n_of_transports; i++)
+        if (transports[i]->move_reply != NULL) transports[i]->move_reply(move_reply);
+}
+
+// searches the bot's move, again with the new depth when the depth changed during the search;
+// returns false when the game was reset
+static bool search_bot_move(const char player, const uint32_t game, uint8_t* move) {
+    for (;;) {
+        set_search_cancelled(false); // before reading game_id and the depth, so a later change cancels the search
+        if (game != game_id) return false;
+        const uint8_t depth = search_depth;
+        set_do_quiescence(depth > 4);
+        set_better_move_order(depth > 2);
+        const int bot_move = bot_place_piece(&game_board, player, depth);
+        if (!is_search_cancelled()) {
+            last_search_stats = get_search_stats();
+            *move = bot_move;
+            return true;
+        }
+        DLOG_I(TAG, "search cancelled");
+    }
+}
+
+// searches and plays the bot's move and sends it to the PIC and the front ends, returns false when the game was reset
+static bool play_bot_move(const char player, const uint32_t game) {
+    uint8_t move;
+    if (!search_bot_move(player, game, &move)) return false;
+    DLOG_I(TAG, "move: %d", move);
+    place_piece(&game_board, move % BOARD_SIZE, move / BOARD_SIZE, player);
+    next_move = move;
+    log_board(&game_board);
+
+    DLOG_I(TAG, "The value sent from esp32 to pic18 is: %d", move);
+    radio_move = (nrf_message_t){.type = NRF_MSG_MOVE, .seq = radio_move.seq + 1, .length = 1, .data = {move}};
+    if (radio_send != NULL) radio_send(&radio_move);
+    notify_bot_moved(move);
+    return true;
+}
+
+// plays the app's move (white, GAME_MOVE_NONE to let the bot start) and the bot's answer, sends the reply
+static void play_move(const GameRequest* request) {
+    move_reply[1] = GAME_MOVE_NONE;
+    move_reply[2] = 0;
+    if (request->move != GAME_MOVE_NONE &&
+        !place_piece(&game_board, request->move % BOARD_SIZE, request->move / BOARD_SIZE, WHITE)) {
+        DLOG_E(TAG, "illegal move %d (seq %d)", request->move, request->seq);
+        move_reply[2] = GAME_MOVE_REJECTED;
+    } else if (check_game_winner()) { // check if white won or draw
+        move_reply[2] = winner;
+    } else {
+        if (!play_bot_move(BLACK, request->game)) return; // reset, no reply
+        move_reply[1] = next_move;
+        if (check_game_winner()) move_reply[2] = winner; // check if black won or draw
+    }
+    move_reply[0] = request->seq;
+    notify_move_reply();
+}
+
+// handles the game requests, so searches don't block the front ends
+static void search_task(void* param) {
+    GameRequest request;
+    for (;;) {
+        handling = false;
+        // peeked first, so game_busy never sees an empty queue before handling is set
+        if (xQueuePeek(game_requests, &request, portMAX_DELAY) != pdTRUE) continue;
+        handling = true;
+        xQueueReceive(game_requests, &request, 0);
+        const uint32_t game = game_id;
+        if (board_game != game) { // reset since, even when its request didn't fit in the queue
+            restart_game_board();
+            board_game = game;
+        }
+        if (request.game != game) continue; // written before a reset
+        switch (request.type) {
+        case REQUEST_BOARD:
+            memcpy(game_board.white, request.white, sizeof(game_board.white));
+            log_board(&game_board);
+            if (check_game_winner()) break; // check if white won or draw
+            if (play_bot_move(BLACK, request.game)) check_game_winner(); // check if black won or draw
+            break;
+        case REQUEST_MOVE:
+            play_move(&request);
+            break;
+        case REQUEST_AUTOPLAY:
+            if (play_bot_move(request.player, request.game)) check_game_winner(); // check if won or draw
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+#if CONFIG_FREERTOS_UNICORE
+// lets the NimBLE host task run between search slices
+static void yield_search() {
+    vTaskDelay(1);
+}
+#endif
+
+bool game_init(const game_radio_send_t send) {
+    radio_send = send;
+    game_requests = xQueueCreate(SEARCH_QUEUE_LEN, sizeof(GameRequest));
+    if (game_requests == NULL) return false;
+#if CONFIG_FREERTOS_UNICORE
+    set_search_yield(yield_search, SEARCH_SLICE_NODES);
+#endif
+    return xTaskCreatePinnedToCore(search_task, "search", SEARCH_TASK_STACK, NULL, SEARCH_TASK_PRIORITY, NULL,
+                                   SEARCH_TASK_CORE) == pdPASS;
+}
+
+void game_add_transport(const GameTransport* transport) {
+    if (n_of_transports < GAME_MAX_TRANSPORTS) transports[n_of_transports++] = transport;
+}
+
+GameResult game_submit_board(const uint16_t white[BOARD_SIZE]) {
+    GameRequest request = {.type = REQUEST_BOARD};
+    memcpy(request.white, white, sizeof(request.white));
+    next_move = GAME_MOVE_NONE; // until the bot's move is played
+    return submit_request(&request);
+}
+
+GameResult game_submit_move(const uint8_t seq, const uint8_t move) {
+    if (move != GAME_MOVE_NONE && move >= BOARD_SIZE*BOARD_SIZE) {
+        DLOG_E(TAG, "illegal move %d (seq %d)", move, seq);
+        return GAME_INVALID;
+    }
+    if (move_seq_valid && seq == move_last_seq) { // retransmission, the move was already played
+        DLOG_I(TAG, "repeated move seq %d", seq);
+        if (move_reply[0] == seq) notify_move_reply(); // else the reply is still being searched
+        return GAME_OK;
+    }
+    GameRequest request = {.type = REQUEST_MOVE, .seq = seq, .move = move};
+    const GameResult result = submit_request(&request);
+    if (result == GAME_OK) { // a move that didn't fit in the queue is retried with its seq, and must be played then
+        move_last_seq = seq;
+        move_seq_valid = true;
+    }
+    return result;
+}
+
+GameResult game_submit_autoplay(const char player) {
+    if (player != BLACK && player != WHITE) return GAME_INVALID;
+    GameRequest request = {.type = REQUEST_AUTOPLAY, .player = player};
+    next_move = GAME_MOVE_NONE; // until the bot's move is played
+    return submit_request(&request);
+}
+
+GameResult game_reset() {
+    game_id++; // drops the queued requests of the old game, the search task restarts the board before the next one
+    set_search_cancelled(true);
+    move_seq_valid = false;
+    next_move = GAME_MOVE_NONE;
+    GameRequest request = {.type = REQUEST_RESET};
+    submit_request(&request); // restarts the board now, or with the next request when the queue is full
+    return GAME_OK;
+}
+
+GameResult game_set_depth(const uint8_t depth) {
+    if (depth < GAME_MIN_DEPTH || depth > GAME_MAX_DEPTH) return GAME_INVALID;
+    search_depth = depth;
+    set_search_cancelled(true); // a running search starts again with the new depth
+    DLOG_I(TAG, "search depth: %d", depth);
+    return GAME_OK;
+}
+
+bool game_resend_move() {
+    DLOG_I(TAG, "The value sent from esp32 to pic18 is: %d", radio_move.data[0]);
+    return radio_send != NULL && radio_send(&radio_move); // same seq, the PIC doesn't play it twice
+}
+
+void game_radio_delivered(const nrf_message_t* message, const bool delivered) {
+    if (message->type != NRF_MSG_MOVE) return;
+    if (delivered) DLOG_I(TAG, "move %d (seq %d) delivered to the PIC", message->data[0], message->seq);
+    else DLOG_E(TAG, "move %d (seq %d) not delivered to the PIC, the app can resend it with the safety characteristic",
+                message->data[0], message->seq);
+}
+
+void game_pic_message(const nrf_message_t* message) {
+    if (message->type == NRF_MSG_STATUS && message->length >= 2) {
+        DLOG_I("pic", "status: safety %d, last move played seq %d", message->data[0], message->data[1]);
+        if (message->data[0] == safety_state) return; // the app only hears about changes
+    } else if (message->type != NRF_MSG_SAFETY || message->length < 1) {
+        return;
+    }
+    safety_state = message->data[0];
+    DLOG_I("pic", "data (from safety system interrupt): %d", message->data[0]);
+    /* Send if safety triggered */
+    if (message->data[0]) {
+        for (int i = 0; i < n_of_transports; i++)
+            if (transports[i]->safety != NULL) transports[i]->safety(message->data[0]);
+    }
+}
+
+bool game_busy() {
+    return handling || uxQueueMessagesWaiting(game_requests) > 0;
+}
+
+uint8_t game_next_move() {
+    return next_move;
+}
+
+uint8_t game_depth() {
+    return search_depth;
+}
+
+char game_take_winner() {
+    const char w = winner;
+    winner = '\0';
+    return w;
+}
+
+uint8_t game_safety_state() {
+    return safety_state;
+}
+
+void game_move_reply(uint8_t reply[3]) {
+    memcpy(reply, move_reply, sizeof(move_reply));
+}
+
+SearchStats game_search_stats() {
+    return last_search_stats;
+}
@@ -0,0 +1,68 @@
+//
+// game.h
+// Developed by the GAME2 Team.
+// Transport independent game core: the board, the search task and the moves sent to the PIC.
+// Front ends (BLE GATT, the line protocol, the loopback) submit requests and are told about the bot's
+// moves through a GameTransport. The radio is a send function, nrf_send_message on the device.
+//
+
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Board.h"
+#include "bot.h"
+#include "nrf_frame.h"
+
+#define GAME_MOVE_NONE 255      // no move (the bot moves first, or the game ended on the app's move)
+#define GAME_MOVE_REJECTED 255  // winner field of the reply to an illegal move (nothing was played)
+#define GAME_MIN_DEPTH 1        // a search of depth 0 has no move
+#define GAME_MAX_DEPTH 9
+#define GAME_MAX_TRANSPORTS 3
+
+// results of the requests
+typedef enum GameResult {
+    GAME_OK,
+    GAME_FULL,    // the request queue is full, the request was dropped
+    GAME_INVALID, // bad argument
+} GameResult;
+
+// front end, every hook is optional and called from the search task (safety from the radio task)
+typedef struct GameTransport {
+    void (*bot_moved)(uint8_t move);             // the bot played (board, move or autoplay request)
+    void (*move_reply)(const uint8_t reply[3]);  // reply of a move request {seq, bot move, winner}
+    void (*safety)(uint8_t state);               // the PIC's safety system tripped or changed
+} GameTransport;
+
+// sends a message to the PIC, returns false when it was dropped
+typedef bool (*game_radio_send_t)(const nrf_message_t* message);
+
+// creates the request queue and the search task, returns false when out of memory
+bool game_init(game_radio_send_t radio_send);
+
+void game_add_transport(const GameTransport* transport);
+
+// requests, queued for the search task (they return without waiting for the search)
+GameResult game_submit_board(const uint16_t white[BOARD_SIZE]); // white bit board, the bot answers as black
+GameResult game_submit_move(uint8_t seq, uint8_t move);        // one white move, a repeated seq is played once
+GameResult game_submit_autoplay(char player);                  // the bot moves for player
+GameResult game_reset();                                       // cancels the search, drops queued requests
+GameResult game_set_depth(uint8_t depth);                      // a running search starts again with it
+bool game_resend_move();                                       // the last move to the PIC, with the same seq
+
+// radio events (radio task)
+void game_radio_delivered(const nrf_message_t* message, bool delivered);
+void game_pic_message(const nrf_message_t* message);
+
+// state read by the front ends
+bool game_busy();                   // requests are queued or being handled
+uint8_t game_next_move();           // the bot's last move, GAME_MOVE_NONE while it searches
+uint8_t game_depth();
+char game_take_winner();            // winner of the last game ('\0' for none), cleared by the read
+uint8_t game_safety_state();
+void game_move_reply(uint8_t reply[3]);
+SearchStats game_search_stats();    // statistics of the bot's last move
+
+#endif //GAME_H
@@ -0,0 +1,178 @@
+//
+// game_line.c
+// Developed by the GAME2 Team.
+// Line protocol front end of the game core, see game_line.h.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game_line.h"
+#include "game.h"
+
+static game_line_write_t line_write = NULL;
+
+static const char* result_name(const uint8_t winner) {
+    switch (winner) {
+    case 0: return "none";
+    case WHITE: return "O";
+    case BLACK: return "X";
+    case EMPTY: return "draw";
+    case GAME_MOVE_REJECTED: return "rejected";
+    default: return "?";
+    }
+}
+
+static void write_line(const char* line) {
+    if (line_write != NULL) line_write(line);
+}
+
+static void answer(const GameResult result) {
+    write_line(result == GAME_OK ? "ok" : result == GAME_FULL ? "error full" : "error invalid");
+}
+
+static void line_bot_moved(const uint8_t move) {
+    char line[16];
+    snprintf(line, sizeof(line), "bot %u", move);
+    write_line(line);
+}
+
+static void line_move_reply(const uint8_t reply[3]) {
+    char line[40];
+    snprintf(line, sizeof(line), "reply %u %u %s", reply[0], reply[1], result_name(reply[2]));
+    write_line(line);
+}
+
+static void line_safety(const uint8_t state) {
+    char line[16];
+    snprintf(line, sizeof(line), "safety %u", state);
+    write_line(line);
+}
+
+static const GameTransport line_transport = {
+    .bot_moved = line_bot_moved,
+    .move_reply = line_move_reply,
+    .safety = line_safety,
+};
+
+void game_line_init(const game_line_write_t write) {
+    line_write = write;
+    game_add_transport(&line_transport);
+}
+
+// parses an unsigned number up to max, returns false when there is none
+static bool parse_number(const char** text, const unsigned long max, const int base, unsigned long* value) {
+    char* end;
+    *value = strtoul(*text, &end, base);
+    if (end == *text || *value > max) return false;
+    *text = end;
+    return true;
+}
+
+static bool at_end(const char* text) {
+    while (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n') text++;
+    return *text == '\0';
+}
+
+void game_line_handle(const char* line) {
+    char command[12];
+    int n = 0;
+    if (sscanf(line, " %11s%n", command, &n) != 1) return; // empty line
+    const char* args = line + n;
+    unsigned long a, b;
+    char text[GAME_LINE_MAX];
+
+    if (strcmp(command, "board") == 0) {
+        uint16_t white[BOARD_SIZE];
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            if (!parse_number(&args, 0xffff, 16, &a)) {
+                write_line("error usage: board <10 hex rows>");
+                return;
+            }
+            white[i] = a;
+        }
+        answer(at_end(args) ? game_submit_board(white) : GAME_INVALID);
+    } else if (strcmp(command, "move") == 0) {
+        if (!parse_number(&args, 255, 10, &a) || !parse_number(&args, 255, 10, &b) || !at_end(args)) {
+            write_line("error usage: move <seq> <cell>");
+            return;
+        }
+        answer(game_submit_move(a, b));
+    } else if (strcmp(command, "autoplay") == 0) {
+        char player;
+        if (sscanf(args, " %c", &player) != 1) {
+            write_line("error usage: autoplay X|O");
+            return;
+        }
+        answer(game_submit_autoplay(player));
+    } else if (strcmp(command, "reset") == 0) {
+        answer(game_reset());
+    } else if (strcmp(command, "depth") == 0) {
+        if (!parse_number(&args, 255, 10, &a) || !at_end(args)) {
+            write_line("error usage: depth <1-9>");
+            return;
+        }
+        answer(game_set_depth(a));
+    } else if (strcmp(command, "resend") == 0) {
+        write_line(game_resend_move() ? "ok" : "error full");
+    } else if (strcmp(command, "state") == 0) {
+        snprintf(text, sizeof(text), "state next %u depth %u safety %u busy %d", game_next_move(), game_depth(),
+                 game_safety_state(), game_busy());
+        write_line(text);
+    } else if (strcmp(command, "winner") == 0) {
+        snprintf(text, sizeof(text), "winner %s", result_name(game_take_winner()));
+        write_line(text);
+    } else if (strcmp(command, "stats") == 0) {
+        const SearchStats stats = game_search_stats();
+        snprintf(text, sizeof(text), "stats depth %d nodes %lu time %lu", stats.reached_depth,
+                 (unsigned long)stats.nodes, (unsigned long)(stats.time_us / 1000));
+        write_line(text);
+    } else {
+        snprintf(text, sizeof(text), "error unknown command %s", command);
+        write_line(text);
+    }
+}
+
+#if CONFIG_GOMOKU_LINE_PROTOCOL
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+
+#define LINE_UART CONFIG_GOMOKU_LINE_UART
+#define LINE_UART_BUFFER 256
+#define LINE_TASK_STACK 3072
+#define LINE_TASK_PRIORITY 3 // below the search task, commands only queue requests
+
+static void uart_write_line(const char* line) {
+    uart_write_bytes(LINE_UART, line, strlen(line));
+    uart_write_bytes(LINE_UART, "\r\n", 2);
+}
+
+static void line_task(void* param) {
+    char line[GAME_LINE_MAX];
+    size_t length = 0;
+    bool too_long = false;
+    for (;;) {
+        uint8_t c;
+        if (uart_read_bytes(LINE_UART, &c, 1, portMAX_DELAY) != 1) continue;
+        if (c != '\r' && c != '\n') {
+            if (length < sizeof(line) - 1) line[length++] = c;
+            else too_long = true;
+            continue;
+        }
+        line[length] = '\0';
+        if (too_long) uart_write_line("error line too long");
+        else game_line_handle(line);
+        length = 0;
+        too_long = false;
+    }
+}
+
+bool game_line_start_uart() {
+    if (!uart_is_driver_installed(LINE_UART) &&
+        uart_driver_install(LINE_UART, LINE_UART_BUFFER, 0, 0, NULL, 0) != ESP_OK)
+        return false;
+    game_line_init(uart_write_line);
+    return xTaskCreate(line_task, "line", LINE_TASK_STACK, NULL, LINE_TASK_PRIORITY, NULL) == pdPASS;
+}
+#endif
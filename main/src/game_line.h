@@ -0,0 +1,43 @@
+//
+// game_line.h
+// Developed by the GAME2 Team.
+// Line protocol front end of the game core, for a UART console, stdin (host/game_stdio.c) or scripts.
+// One command per line, answered by "ok", a state line or "error <reason>":
+//   board <r0> ... <r9>    white bit board, 10 hex rows like the gomoku bot characteristic, the bot answers as X
+//   move <seq> <cell>      one O move (cell y*10+x, 255 lets the bot start), a repeated seq is played once
+//   autoplay X|O           the bot moves for X or O
+//   reset | depth <1-9> | resend
+//   state                  "state next <move> depth <depth> safety <state> busy <0|1>"
+//   winner                 "winner O|X|draw|none", cleared by the read
+//   stats                  "stats depth <depth> nodes <nodes> time <ms>" of the bot's last move
+// Events of the search and radio tasks, written whenever they happen:
+//   bot <move>                        the bot played
+//   reply <seq> <move> <result>       reply of a move command, result none|O|X|draw|rejected
+//   safety <state>                    the PIC's safety system tripped
+//
+
+#ifndef GAME_LINE_H
+#define GAME_LINE_H
+
+#include <stdbool.h>
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#define GAME_LINE_MAX 96 // longest command line
+
+// writes one line, without the newline; called from the command's task and the search and radio tasks
+typedef void (*game_line_write_t)(const char* line);
+
+// registers the front end (after game_init)
+void game_line_init(game_line_write_t write);
+
+// handles one command line (trailing newline optional)
+void game_line_handle(const char* line);
+
+#if CONFIG_GOMOKU_LINE_PROTOCOL
+// reads commands from UART CONFIG_GOMOKU_LINE_UART in a task and writes the answers and events back
+bool game_line_start_uart();
+#endif
+
+#endif //GAME_LINE_H
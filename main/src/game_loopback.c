@@ -0,0 +1,52 @@
+//
+// game_loopback.c
+// Developed by the GAME2 Team.
+// In-process front end of the game core, see game_loopback.h.
+//
+#include <string.h>
+
+#include "game_loopback.h"
+#include "game.h"
+#include "dlog.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#define TAG "loopback"
+
+static QueueHandle_t events;
+
+// called from the search and radio tasks, which must not wait for the client
+static void push(const GameEventType type, const uint8_t* data, const int length) {
+    GameEvent event = {.type = type};
+    memcpy(event.data, data, length);
+    if (xQueueSend(events, &event, 0) != pdTRUE) DLOG_W(TAG, "event queue full, event %d dropped", type);
+}
+
+static void loopback_bot_moved(const uint8_t move) {
+    push(GAME_EVENT_BOT_MOVED, &move, 1);
+}
+
+static void loopback_move_reply(const uint8_t reply[3]) {
+    push(GAME_EVENT_MOVE_REPLY, reply, 3);
+}
+
+static void loopback_safety(const uint8_t state) {
+    push(GAME_EVENT_SAFETY, &state, 1);
+}
+
+static const GameTransport loopback_transport = {
+    .bot_moved = loopback_bot_moved,
+    .move_reply = loopback_move_reply,
+    .safety = loopback_safety,
+};
+
+bool game_loopback_init() {
+    events = xQueueCreate(GAME_LOOPBACK_EVENTS, sizeof(GameEvent));
+    if (events == NULL) return false;
+    game_add_transport(&loopback_transport);
+    return true;
+}
+
+bool game_loopback_wait(GameEvent* event, const uint32_t timeout_ms) {
+    return xQueueReceive(events, event, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
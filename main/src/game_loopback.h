@@ -0,0 +1,33 @@
+//
+// game_loopback.h
+// Developed by the GAME2 Team.
+// In-process front end of the game core: its events are queued for a client task that waits on them,
+// for load tests and scripted games without BLE or a UART.
+//
+
+#ifndef GAME_LOOPBACK_H
+#define GAME_LOOPBACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GAME_LOOPBACK_EVENTS 16 // events not waited on yet, later ones are dropped
+
+typedef enum GameEventType {
+    GAME_EVENT_BOT_MOVED,  // data[0]: the bot's move
+    GAME_EVENT_MOVE_REPLY, // data: {seq, bot move, winner} of a move request
+    GAME_EVENT_SAFETY,     // data[0]: safety system state
+} GameEventType;
+
+typedef struct GameEvent {
+    GameEventType type;
+    uint8_t data[3];
+} GameEvent;
+
+// creates the event queue and registers the front end (after game_init), returns false when out of memory
+bool game_loopback_init();
+
+// waits for the next event, returns false on timeout
+bool game_loopback_wait(GameEvent* event, uint32_t timeout_ms);
+
+#endif //GAME_LOOPBACK_H
@@ -7,7 +7,8 @@
 /* Includes */
 #include "gatt_svc.h"
 #include "common.h"
-#include "bot.h"
+#include "game.h"
+#include "dlog.h"
 
 /* Private function declarations */                
 static int gomoku_bot_chr_access(uint16_t conn_handle, uint16_t attr_handle,
@@ -22,27 +23,30 @@ static int reset_board_chr_access(uint16_t conn_handle, uint16_t attr_handle,
                             struct ble_gatt_access_ctxt *ctxt, void *arg);
 static int autoplay_chr_access(uint16_t conn_handle, uint16_t attr_handle,
                             struct ble_gatt_access_ctxt *ctxt, void *arg);
+static int search_stats_chr_access(uint16_t conn_handle, uint16_t attr_handle,
+                            struct ble_gatt_access_ctxt *ctxt, void *arg);
+static int move_chr_access(uint16_t conn_handle, uint16_t attr_handle,
+                            struct ble_gatt_access_ctxt *ctxt, void *arg);
 
 /* Private variables */
 /* Gomoku Bot service */
 static const ble_uuid16_t gomoku_bot_svc_uuid = BLE_UUID16_INIT(0x181C);
 
-static uint8_t gomoku_bot_chr_next_move = 255;
+static uint16_t gomoku_bot_chr_conn_handle = 0;
+static bool gomoku_bot_chr_conn_handle_inited = false;
+static bool gomoku_bot_notify_status = false;
 static uint16_t gomoku_bot_chr_val_handle;
 static const ble_uuid16_t gomoku_bot_chr_uuid = BLE_UUID16_INIT(0x2A46);
 
-static uint8_t gomoku_bot_search_depth = 5;
 static uint16_t search_depth_chr_val_handle;
 static const ble_uuid16_t search_depth_chr_uuid = BLE_UUID16_INIT(0x2A47);
 
-static char gomoku_bot_winner = '\0';
 static uint16_t winner_chr_val_handle;
 static const ble_uuid16_t winner_chr_uuid = BLE_UUID16_INIT(0x2A48);
 
 static uint16_t safety_chr_conn_handle = 0;
 static bool safety_chr_conn_handle_inited = false;
 static bool safety_ind_status = false;
-static uint8_t safety_state = 0;
 static uint16_t safety_chr_val_handle;
 static const ble_uuid16_t safety_chr_uuid = BLE_UUID16_INIT(0x2A49);
 
@@ -52,7 +56,15 @@ static const ble_uuid16_t reset_board_chr_uuid = BLE_UUID16_INIT(0x2A4A);
 static uint16_t autoplay_chr_val_handle;
 static const ble_uuid16_t autoplay_chr_uuid = BLE_UUID16_INIT(0x2A4B);
 
-Board game_board;
+static uint16_t search_stats_chr_val_handle;
+static const ble_uuid16_t search_stats_chr_uuid = BLE_UUID16_INIT(0x2A4C);
+
+// move protocol: the app writes {seq, move}, the reply {seq, bot move, winner} is notified
+static uint16_t move_chr_conn_handle = 0;
+static bool move_chr_conn_handle_inited = false;
+static bool move_notify_status = false;
+static uint16_t move_chr_val_handle;
+static const ble_uuid16_t move_chr_uuid = BLE_UUID16_INIT(0x2A4D);
 
 /* GATT services table */
 static const struct ble_gatt_svc_def gatt_svr_svcs[] = {
@@ -63,7 +75,7 @@ static const struct ble_gatt_svc_def gatt_svr_svcs[] = {
                 {/* Gomoku bot characteristic */
                  .uuid = &gomoku_bot_chr_uuid.u,
                  .access_cb = gomoku_bot_chr_access,
-                 .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE,
+                 .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_NOTIFY,
                  .val_handle = &gomoku_bot_chr_val_handle},
                 {/* Search depth characteristic */
                     .uuid = &search_depth_chr_uuid.u,
@@ -90,6 +102,16 @@ static const struct ble_gatt_svc_def gatt_svr_svcs[] = {
                     .access_cb = autoplay_chr_access,
                     .flags = BLE_GATT_CHR_F_WRITE,
                     .val_handle = &autoplay_chr_val_handle},
+                {/* Search statistics characteristic */
+                    .uuid = &search_stats_chr_uuid.u,
+                    .access_cb = search_stats_chr_access,
+                    .flags = BLE_GATT_CHR_F_READ,
+                    .val_handle = &search_stats_chr_val_handle},
+                {/* Move characteristic */
+                    .uuid = &move_chr_uuid.u,
+                    .access_cb = move_chr_access,
+                    .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_NOTIFY,
+                    .val_handle = &move_chr_val_handle},
                 {
                     0, /* No more characteristics in this service. */
                 }}},
@@ -99,22 +121,49 @@ static const struct ble_gatt_svc_def gatt_svr_svcs[] = {
     },
 };
 
-void restart_game_board() {
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        game_board.black[i] = 0;
+// sends the bot's move (gomoku bot characteristic) to the subscribed app
+static void send_bot_move_notification() {
+    if (gomoku_bot_notify_status && gomoku_bot_chr_conn_handle_inited) {
+        ble_gatts_notify(gomoku_bot_chr_conn_handle, gomoku_bot_chr_val_handle);
+        DLOG_I(TAG, "bot move notification sent!");
+    }
+}
+
+// sends the reply of the move characteristic to the subscribed app
+static void send_move_notification() {
+    if (move_notify_status && move_chr_conn_handle_inited) {
+        ble_gatts_notify(move_chr_conn_handle, move_chr_val_handle);
+        DLOG_I(TAG, "move notification sent!");
     }
-    gomoku_bot_chr_next_move = 255;
-    reset_bot();
-    ESP_LOGI(TAG, "board reset.");
 }
 
-bool gomoku_bot_check_winner() {
-    char winner = check_winner(&game_board);
-    printf("%c\n", winner);
-    if (winner == '\0') return false; // game keeps going
-    gomoku_bot_winner = winner;
-    restart_game_board();
-    return true;
+static void send_safety_system_indication(uint8_t trigger);
+
+// the app is a front end of the game core, the notifications read the characteristics again
+static void gatt_bot_moved(uint8_t move) {
+    send_bot_move_notification();
+}
+
+static void gatt_move_reply(const uint8_t reply[3]) {
+    send_move_notification();
+}
+
+static const GameTransport gatt_transport = {
+    .bot_moved = gatt_bot_moved,
+    .move_reply = gatt_move_reply,
+    .safety = send_safety_system_indication,
+};
+
+// ATT error of a game request, the write returns without waiting for the search
+static int gatt_result(const GameResult result) {
+    switch (result) {
+    case GAME_OK:
+        return 0;
+    case GAME_FULL:
+        return BLE_ATT_ERR_INSUFFICIENT_RES;
+    default:
+        return BLE_ATT_ERR_VALUE_NOT_ALLOWED;
+    }
 }
 
 /* Private functions */
@@ -130,19 +179,19 @@ static int gomoku_bot_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     case BLE_GATT_ACCESS_OP_READ_CHR:
         /* Verify connection handle */
         if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            ESP_LOGI(TAG, "characteristic read; conn_handle=%d attr_handle=%d",
+            DLOG_I(TAG, "characteristic read; conn_handle=%d attr_handle=%d",
                      conn_handle, attr_handle);
         } else {
-            ESP_LOGI(TAG, "characteristic read by nimble stack; attr_handle=%d",
+            DLOG_I(TAG, "characteristic read by nimble stack; attr_handle=%d",
                      attr_handle);
         }
 
         /* Verify attribute handle */
         if (attr_handle == gomoku_bot_chr_val_handle) {
             /* Update access buffer value */
-            rc = os_mbuf_append(ctxt->om, &gomoku_bot_chr_next_move,
-                                sizeof(gomoku_bot_chr_next_move));
-            ESP_LOGI(TAG, "move read: %d", gomoku_bot_chr_next_move);
+            const uint8_t next_move = game_next_move();
+            rc = os_mbuf_append(ctxt->om, &next_move, sizeof(next_move));
+            DLOG_I(TAG, "move read: %d", next_move);
             return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
         }
         goto error;
@@ -150,10 +199,10 @@ static int gomoku_bot_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     case BLE_GATT_ACCESS_OP_WRITE_CHR:
         /* Verify connection handle */
         if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            ESP_LOGI(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
+            DLOG_I(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
                      conn_handle, attr_handle);
         } else {
-            ESP_LOGI(TAG,
+            DLOG_I(TAG,
                      "characteristic write by nimble stack; attr_handle=%d",
                      attr_handle);
         }
@@ -161,26 +210,12 @@ static int gomoku_bot_chr_access(uint16_t conn_handle, uint16_t attr_handle,
         if (attr_handle == gomoku_bot_chr_val_handle) {
             /* Verify access buffer length */
             if (ctxt->om->om_len == sizeof(Board)/2) {
-                for (int i = 0; i < 2*BOARD_SIZE; i += 2) { // update game board with white pieces
-                    game_board.white[i/2] = (ctxt->om->om_data[i] << 8) | ctxt->om->om_data[i+1];
+                uint16_t white[BOARD_SIZE];
+                for (int i = 0; i < 2*BOARD_SIZE; i += 2) { // white pieces
+                    white[i/2] = (ctxt->om->om_data[i] << 8) | ctxt->om->om_data[i+1];
                 }
-                // find next move and update game board with new black piece
-                print_board(&game_board);
-                
-                if (gomoku_bot_check_winner()) return 0; // check if white won or draw
-
-                gomoku_bot_chr_next_move = bot_place_piece(&game_board, BLACK, gomoku_bot_search_depth);
-                ESP_LOGI(TAG, "move: %d", gomoku_bot_chr_next_move);
-                place_piece(&game_board, gomoku_bot_chr_next_move % BOARD_SIZE, gomoku_bot_chr_next_move / BOARD_SIZE, BLACK);
-                
-                printf("The value sent from esp32 to pic18 is: %d ", gomoku_bot_chr_next_move);
-                nrf_send_data(&gomoku_bot_chr_next_move, 1);
-                
-                gomoku_bot_check_winner(); // check if black won or draw
-            } else {
-                goto error;
+                return gatt_result(game_submit_board(white)); // 255 is read until the bot's move is notified
             }
-            return 0;
         }
         goto error;
 
@@ -190,13 +225,65 @@ static int gomoku_bot_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     }
 
 error:
-    ESP_LOGE(
+    DLOG_E(
         TAG,
         "unexpected access operation to gomoku bot characteristic, opcode: %d",
         ctxt->op);
     return BLE_ATT_ERR_UNLIKELY;
 }
 
+static int move_chr_access(uint16_t conn_handle, uint16_t attr_handle,
+                           struct ble_gatt_access_ctxt *ctxt, void *arg) {
+    /* Local variables */
+    int rc;
+
+    /* Handle access events */
+    switch (ctxt->op) {
+
+    /* Read characteristic event */
+    case BLE_GATT_ACCESS_OP_READ_CHR:
+        /* Verify attribute handle */
+        if (attr_handle == move_chr_val_handle) {
+            /* Update access buffer value */
+            uint8_t reply[3];
+            game_move_reply(reply);
+            rc = os_mbuf_append(ctxt->om, reply, sizeof(reply));
+            DLOG_I(TAG, "move reply read: seq %d, move %d, winner %d", reply[0], reply[1], reply[2]);
+            return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+        }
+        goto error;
+
+    case BLE_GATT_ACCESS_OP_WRITE_CHR:
+        /* Verify connection handle */
+        if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
+            DLOG_I(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
+                     conn_handle, attr_handle);
+        } else {
+            DLOG_I(TAG,
+                     "characteristic write by nimble stack; attr_handle=%d",
+                     attr_handle);
+        }
+        /* Verify attribute handle */
+        if (attr_handle == move_chr_val_handle) {
+            /* Verify access buffer length */
+            if (ctxt->om->om_len != 2) goto error;
+            return gatt_result(game_submit_move(ctxt->om->om_data[0], ctxt->om->om_data[1]));
+        }
+        goto error;
+
+    /* Unknown event */
+    default:
+        goto error;
+    }
+
+error:
+    DLOG_E(
+        TAG,
+        "unexpected access operation to move characteristic, opcode: %d",
+        ctxt->op);
+    return BLE_ATT_ERR_UNLIKELY;
+}
+
 static int search_depth_chr_access(uint16_t conn_handle, uint16_t attr_handle,
                                  struct ble_gatt_access_ctxt *ctxt, void *arg) {
     /* Local variables */
@@ -209,19 +296,19 @@ static int search_depth_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     case BLE_GATT_ACCESS_OP_READ_CHR:
         /* Verify connection handle */
         if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            ESP_LOGI(TAG, "characteristic read; conn_handle=%d attr_handle=%d",
+            DLOG_I(TAG, "characteristic read; conn_handle=%d attr_handle=%d",
                      conn_handle, attr_handle);
         } else {
-            ESP_LOGI(TAG, "characteristic read by nimble stack; attr_handle=%d",
+            DLOG_I(TAG, "characteristic read by nimble stack; attr_handle=%d",
                      attr_handle);
         }
 
         /* Verify attribute handle */
         if (attr_handle == search_depth_chr_val_handle) {
             /* Update access buffer value */
-            rc = os_mbuf_append(ctxt->om, &gomoku_bot_search_depth,
-                                sizeof(gomoku_bot_search_depth));
-            ESP_LOGI(TAG, "move read: %d", gomoku_bot_search_depth);
+            const uint8_t depth = game_depth();
+            rc = os_mbuf_append(ctxt->om, &depth, sizeof(depth));
+            DLOG_I(TAG, "move read: %d", depth);
             return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
         }
         goto error;
@@ -229,22 +316,18 @@ static int search_depth_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     case BLE_GATT_ACCESS_OP_WRITE_CHR:
         /* Verify connection handle */
         if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            ESP_LOGI(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
+            DLOG_I(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
                      conn_handle, attr_handle);
         } else {
-            ESP_LOGI(TAG,
+            DLOG_I(TAG,
                      "characteristic write by nimble stack; attr_handle=%d",
                      attr_handle);
         }
         /* Verify attribute handle */
         if (attr_handle == search_depth_chr_val_handle) {
             /* Verify access buffer length */
-            if (ctxt->om->om_len == sizeof(uint8_t) && ctxt->om->om_data[0] < 10) { // change search depth (difficulty)
-                gomoku_bot_search_depth = ctxt->om->om_data[0];
-                set_do_quiescence(ctxt->om->om_data[0] > 4);
-                set_better_move_order(ctxt->om->om_data[0] > 2);
-                ESP_LOGI(TAG, "search depth: %d", gomoku_bot_search_depth);
-            } else {
+            if (ctxt->om->om_len != sizeof(uint8_t) ||
+                game_set_depth(ctxt->om->om_data[0]) != GAME_OK) { // change search depth (difficulty)
                 goto error;
             }
             return 0;
@@ -257,7 +340,7 @@ static int search_depth_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     }
 
 error:
-    ESP_LOGE(
+    DLOG_E(
         TAG,
         "unexpected access operation to gomoku bot characteristic, opcode: %d",
         ctxt->op);
@@ -276,19 +359,19 @@ static int winner_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     case BLE_GATT_ACCESS_OP_READ_CHR:
         /* Verify connection handle */
         if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            ESP_LOGI(TAG, "characteristic read; conn_handle=%d attr_handle=%d",
+            DLOG_I(TAG, "characteristic read; conn_handle=%d attr_handle=%d",
                      conn_handle, attr_handle);
         } else {
-            ESP_LOGI(TAG, "characteristic read by nimble stack; attr_handle=%d",
+            DLOG_I(TAG, "characteristic read by nimble stack; attr_handle=%d",
                      attr_handle);
         }
 
         /* Verify attribute handle */
         if (attr_handle == winner_chr_val_handle) {
             /* Update access buffer value */
-            rc = os_mbuf_append(ctxt->om, &gomoku_bot_winner, sizeof(gomoku_bot_winner));
-            ESP_LOGI(TAG, "winner read: %d", gomoku_bot_winner);
-            gomoku_bot_winner = '\0';
+            const char winner = game_take_winner();
+            rc = os_mbuf_append(ctxt->om, &winner, sizeof(winner));
+            DLOG_I(TAG, "winner read: %d", winner);
             return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
         }
         goto error;
@@ -299,7 +382,7 @@ static int winner_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     }
 
 error:
-    ESP_LOGE(
+    DLOG_E(
         TAG,
         "unexpected access operation to winner characteristic, opcode: %d",
         ctxt->op);
@@ -318,18 +401,19 @@ static int safety_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     case BLE_GATT_ACCESS_OP_READ_CHR:
         /* Verify connection handle */
         if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            ESP_LOGI(TAG, "characteristic read; conn_handle=%d attr_handle=%d",
+            DLOG_I(TAG, "characteristic read; conn_handle=%d attr_handle=%d",
                      conn_handle, attr_handle);
         } else {
-            ESP_LOGI(TAG, "characteristic read by nimble stack; attr_handle=%d",
+            DLOG_I(TAG, "characteristic read by nimble stack; attr_handle=%d",
                      attr_handle);
         }
 
         /* Verify attribute handle */
         if (attr_handle == safety_chr_val_handle) {
             /* Update access buffer value */
+            const uint8_t safety_state = game_safety_state();
             rc = os_mbuf_append(ctxt->om, &safety_state, sizeof(safety_state));
-            ESP_LOGI(TAG, "safety system read: %d", safety_state);
+            DLOG_I(TAG, "safety system read: %d", safety_state);
             return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
         }
         goto error;
@@ -337,10 +421,10 @@ static int safety_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     case BLE_GATT_ACCESS_OP_WRITE_CHR:
         /* Verify connection handle */
         if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            ESP_LOGI(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
+            DLOG_I(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
                      conn_handle, attr_handle);
         } else {
-            ESP_LOGI(TAG,
+            DLOG_I(TAG,
                      "characteristic write by nimble stack; attr_handle=%d",
                      attr_handle);
         }
@@ -348,8 +432,7 @@ static int safety_chr_access(uint16_t conn_handle, uint16_t attr_handle,
         if (attr_handle == safety_chr_val_handle) {
             /* Verify access buffer length */
             if (ctxt->om->om_len == sizeof(uint8_t)) { // retry move after safety system interrupted it
-                printf("The value sent from esp32 to pic18 is: %d ", gomoku_bot_chr_next_move);
-                nrf_send_data(&gomoku_bot_chr_next_move, 1);
+                game_resend_move(); // same seq, the PIC doesn't play it twice
             } else {
                 goto error;
             }
@@ -363,7 +446,7 @@ static int safety_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     }
 
 error:
-    ESP_LOGE(
+    DLOG_E(
         TAG,
         "unexpected access operation to winner characteristic, opcode: %d",
         ctxt->op);
@@ -378,10 +461,10 @@ static int reset_board_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     case BLE_GATT_ACCESS_OP_WRITE_CHR:
         /* Verify connection handle */
         if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            ESP_LOGI(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
+            DLOG_I(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
                      conn_handle, attr_handle);
         } else {
-            ESP_LOGI(TAG,
+            DLOG_I(TAG,
                      "characteristic write by nimble stack; attr_handle=%d",
                      attr_handle);
         }
@@ -389,11 +472,10 @@ static int reset_board_chr_access(uint16_t conn_handle, uint16_t attr_handle,
         if (attr_handle == reset_board_chr_val_handle) {
             /* Verify access buffer length */
             if (ctxt->om->om_len == sizeof(uint8_t)) {
-                restart_game_board();
+                return gatt_result(game_reset());
             } else {
                 goto error;
             }
-            return 0;
         }
         goto error;
 
@@ -403,7 +485,7 @@ static int reset_board_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     }
 
 error:
-    ESP_LOGE(
+    DLOG_E(
         TAG,
         "unexpected access operation to gomoku bot characteristic, opcode: %d",
         ctxt->op);
@@ -418,10 +500,10 @@ static int autoplay_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     case BLE_GATT_ACCESS_OP_WRITE_CHR:
         /* Verify connection handle */
         if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            ESP_LOGI(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
+            DLOG_I(TAG, "characteristic write; conn_handle=%d attr_handle=%d",
                      conn_handle, attr_handle);
         } else {
-            ESP_LOGI(TAG,
+            DLOG_I(TAG,
                      "characteristic write by nimble stack; attr_handle=%d",
                      attr_handle);
         }
@@ -429,20 +511,10 @@ static int autoplay_chr_access(uint16_t conn_handle, uint16_t attr_handle,
         if (attr_handle == autoplay_chr_val_handle) {
             /* Verify access buffer length */
             if (ctxt->om->om_len == sizeof(char)) {
-                uint8_t next_move = bot_place_piece(&game_board, ctxt->om->om_data[0], gomoku_bot_search_depth);
-                ESP_LOGI(TAG, "move: %d", next_move);
-                place_piece(&game_board, next_move % BOARD_SIZE, next_move / BOARD_SIZE, ctxt->om->om_data[0]);
-
-                print_board(&game_board);
-                
-                printf("The value sent from esp32 to pic18 is: %d ", next_move);
-                nrf_send_data(&next_move, 1);
-                
-                gomoku_bot_check_winner(); // check if won or draw
+                return gatt_result(game_submit_autoplay(ctxt->om->om_data[0]));
             } else {
                 goto error;
             }
-            return 0;
         }
         goto error;
 
@@ -452,29 +524,116 @@ static int autoplay_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     }
 
 error:
-    ESP_LOGE(
+    DLOG_E(
         TAG,
         "unexpected access operation to gomoku bot characteristic, opcode: %d",
         ctxt->op);
     return BLE_ATT_ERR_UNLIKELY;
 }
 
-void send_safety_system_indication(uint8_t trigger) {
-    safety_state = trigger;
+// appends a little endian 32 bit value
+static uint8_t* put_u32(uint8_t* buf, const uint32_t value) {
+    buf[0] = value;
+    buf[1] = value >> 8;
+    buf[2] = value >> 16;
+    buf[3] = value >> 24;
+    return buf + 4;
+}
+
+/*
+ *  Search statistics wire format (little endian, SEARCH_STATS_LEN bytes):
+ *      u8  version (2), u8 reached depth, u16 effective branching factor * 100
+ *      u32 nodes, quiescence nodes, t_table probes, hits, cutoffs, stores, overwrites,
+ *          evaluations, evaluation cache hits, quiescent evaluations, null prunes,
+ *          cutoffs, first move cutoffs, time (us)
+ *      u32 nodes and time (us) of every depth 1..MAX_SEARCH_DEPTH
+ *      u32 deepest ply, search stack bytes, task stack high water (bytes free),
+ *          free heap, lowest free heap since boot
+ */
+#define SEARCH_STATS_LEN (4 + 14*4 + 2*MAX_SEARCH_DEPTH*4 + 5*4)
+
+static void serialize_search_stats(const SearchStats *stats, uint8_t *buf) {
+    const uint16_t ebf = (uint16_t)(effective_branching_factor(stats) * 100);
+    *buf++ = 2;
+    *buf++ = stats->reached_depth;
+    *buf++ = ebf;
+    *buf++ = ebf >> 8;
+    const uint32_t counters[] = {stats->nodes, stats->q_nodes, stats->t_t_probes, stats->t_t_hits,
+                                 stats->t_t_cutoffs, stats->t_t_stores, stats->t_t_overwrites,
+                                 stats->evaluations, stats->eval_cache_hits, stats->q_evaluations,
+                                 stats->null_prunes, stats->cutoffs, stats->first_move_cutoffs, stats->time_us};
+    for (int i = 0; i < 14; i++) buf = put_u32(buf, counters[i]);
+    for (int depth = 1; depth <= MAX_SEARCH_DEPTH; depth++) {
+        buf = put_u32(buf, stats->iteration_nodes[depth]);
+        buf = put_u32(buf, stats->iteration_us[depth]);
+    }
+    buf = put_u32(buf, stats->max_ply);
+    buf = put_u32(buf, stats->stack_bytes);
+    buf = put_u32(buf, stats->stack_free_min);
+    buf = put_u32(buf, stats->heap_free);
+    put_u32(buf, stats->heap_free_min);
+}
+
+static int search_stats_chr_access(uint16_t conn_handle, uint16_t attr_handle,
+                                 struct ble_gatt_access_ctxt *ctxt, void *arg) {
+    /* Local variables */
+    int rc;
+    uint8_t buf[SEARCH_STATS_LEN];
+
+    /* Handle access events */
+    switch (ctxt->op) {
+
+    /* Read characteristic event */
+    case BLE_GATT_ACCESS_OP_READ_CHR:
+        /* Verify connection handle */
+        if (conn_handle != BLE_HS_CONN_HANDLE_NONE) {
+            DLOG_I(TAG, "characteristic read; conn_handle=%d attr_handle=%d",
+                     conn_handle, attr_handle);
+        } else {
+            DLOG_I(TAG, "characteristic read by nimble stack; attr_handle=%d",
+                     attr_handle);
+        }
+
+        /* Verify attribute handle */
+        if (attr_handle == search_stats_chr_val_handle) {
+            /* Update access buffer value */
+            const SearchStats stats = game_search_stats();
+            serialize_search_stats(&stats, buf);
+            rc = os_mbuf_append(ctxt->om, buf, sizeof(buf));
+            DLOG_I(TAG, "search stats read: depth %d, %lu nodes", stats.reached_depth, (unsigned long)stats.nodes);
+            return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+        }
+        goto error;
+
+    /* Unknown event */
+    default:
+        goto error;
+    }
+
+error:
+    DLOG_E(
+        TAG,
+        "unexpected access operation to search stats characteristic, opcode: %d",
+        ctxt->op);
+    return BLE_ATT_ERR_UNLIKELY;
+}
+
+// indicates the safety system state to the subscribed app
+static void send_safety_system_indication(uint8_t trigger) {
     if (safety_ind_status && safety_chr_conn_handle_inited) {
         ble_gatts_indicate(safety_chr_conn_handle,
                         safety_chr_val_handle);
-        ESP_LOGI(TAG, "safety system notification sent!");
+        DLOG_I(TAG, "safety system notification sent!");
     }
 }
 
 void gatt_svr_subscribe_cb(struct ble_gap_event *event) {
     /* Check connection handle */
     if (event->subscribe.conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-        ESP_LOGI(TAG, "subscribe event; conn_handle=%d attr_handle=%d",
+        DLOG_I(TAG, "subscribe event; conn_handle=%d attr_handle=%d",
                 event->subscribe.conn_handle, event->subscribe.attr_handle);
     } else {
-        ESP_LOGI(TAG, "subscribe by nimble stack; attr_handle=%d",
+        DLOG_I(TAG, "subscribe by nimble stack; attr_handle=%d",
                 event->subscribe.attr_handle);
     }
 
@@ -485,6 +644,16 @@ void gatt_svr_subscribe_cb(struct ble_gap_event *event) {
         safety_chr_conn_handle_inited = true;
         safety_ind_status = event->subscribe.cur_indicate;
     }
+    if (event->subscribe.attr_handle == gomoku_bot_chr_val_handle) {
+        gomoku_bot_chr_conn_handle = event->subscribe.conn_handle;
+        gomoku_bot_chr_conn_handle_inited = true;
+        gomoku_bot_notify_status = event->subscribe.cur_notify;
+    }
+    if (event->subscribe.attr_handle == move_chr_val_handle) {
+        move_chr_conn_handle = event->subscribe.conn_handle;
+        move_chr_conn_handle_inited = true;
+        move_notify_status = event->subscribe.cur_notify;
+    }
 }
 
 /*
@@ -535,6 +704,7 @@ void gatt_svr_register_cb(struct ble_gatt_register_ctxt *ctxt, void *arg) {
  *      1. Initialize GATT service
  *      2. Update NimBLE host GATT services counter
  *      3. Add GATT services to server
+ *      4. Register as a front end of the game core
  */
 int gatt_svc_init(void) {
     /* Local variables */
@@ -555,5 +725,8 @@ int gatt_svc_init(void) {
         return rc;
     }
 
+    /* 4. Game front end */
+    game_add_transport(&gatt_transport);
+
     return 0;
 }
@@ -5,71 +5,301 @@
 //
 
 #include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
 #include "hashmap.h"
 
 #include "zobrist.h"
 
-zobrist_t k;
+zobrist_t k; // written once by the first init_map/init_shared_map, read only afterwards
+static pthread_once_t k_once = PTHREAD_ONCE_INIT;
 
-// allocate and initialize hashmap
+static void init_zobrist_keys() {
+    init_zobrist(&k);
+}
+
+// initialize the zobrist keys once, so every map (and every task) hashes boards the same way.
+// Tasks calling it together wait for the first one
+static void init_keys() {
+    pthread_once(&k_once, init_zobrist_keys);
+}
+
+// zobrist key of a board (the same key indexes the transposition table)
+uint32_t hash_board(const Board *board) {
+    return zobrist(board, &k);
+}
+
+// FNV-1a over the rows, independent of the Zobrist key (verifies evaluation cache hits)
+uint32_t check_hash_board(const Board *board) {
+    uint32_t hash = BASE;
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        hash = (hash ^ ((uint32_t)board->white[i] << 16 | board->black[i])) * PRIME;
+    }
+    return hash;
+}
+
+// smallest zobrist key over the 8 symmetries of a board, sym is set to the symmetry that gives it
+uint32_t canonical_hash_board(const Board *board, int *sym) {
+    uint32_t min_key = zobrist(board, &k);
+    *sym = 0;
+    for (int i = 1; i < N_OF_SYMMETRIES; i++) {
+        Board transformed;
+        transform_board(board, &transformed, i);
+        const uint32_t key = zobrist(&transformed, &k);
+        if (key < min_key) {
+            min_key = key;
+            *sym = i;
+        }
+    }
+    return min_key;
+}
+
+// allocate and initialize hashmap, buckets is NULL (and cap 0) when out of memory
 Map init_map(const int cap) {
-    Map m = {0, cap, NULL};
+    Map m = {0, cap, NULL, 0, 0, 0};
     m.buckets = malloc(sizeof(data) * m.cap);
+    if (m.buckets == NULL) m.cap = 0;
     empty_map(&m);
-    init_zobrist(&k);
+    init_keys();
     return m;
 }
 
+// check if a bucket is free (never used or left over from a previous game)
+static bool is_free(const Map *m, const data *bucket) {
+    return bucket->depth == -1 || bucket->age < m->game_age;
+}
+
+// start a new search: entries stored from now on get a newer age
+void new_search_map(Map *m, const Board *root) {
+    if (m->age >= MAX_AGE) {
+        empty_map(m); // out of ages, fall back to a full clear
+    } else {
+        m->age++;
+    }
+    m->root_pieces = count1s(root->black) + count1s(root->white);
+}
+
+// start a new game: every stored entry becomes free without touching the buckets
+void new_game_map(Map *m) {
+    if (m->age >= MAX_AGE - 1) {
+        empty_map(m); // out of ages, fall back to a full clear
+        return;
+    }
+    m->game_age = m->age + 1;
+    m->age = m->game_age;
+    m->size = 0;
+}
+
 // put a new search into the transposition table
-void put_map(Map *m, const Board *board, const int value, const int depth, const int best_move, const bool quiescence) {//, const NodeType type) {
-    const uint32_t key = zobrist(board, &k);
+PutResult put_map(Map *m, const Board *board, const int value, const int depth, const int best_move, const bool quiescence) {//, const NodeType type) {
+    return put_map_key(m, zobrist(board, &k), count1s(board->black) + count1s(board->white), value, depth, best_move, quiescence);
+}
+
+// put a new search into the transposition table under an already computed key
+PutResult put_map_key(Map *m, const uint32_t key, const int n_of_pieces, const int value, const int depth, const int best_move, const bool quiescence) {
     const unsigned int hkey = key % m->cap;
     const unsigned int hash2 = 11 - key % 11;
-    const int n_of_pieces = count1s(board->black) + count1s(board->white);
     for(int i = 0; i < m->cap; i++) {
         const unsigned int index = (hkey + i * hash2) % m->cap;
-        if (m->buckets[index].key == key) { // position is already in transposition table
-            if (m->buckets[index].depth < depth) { // depth is bigger -> more accurate score -> swap
-                m->buckets[index].depth = depth;
-                m->buckets[index].score = value;
-                m->buckets[index].best_move = best_move;
-            }
-            return;
-        }
-        if(m->buckets[index].depth == -1) { // position is not in transposition table
+        data *bucket = &m->buckets[index];
+        if (is_free(m, bucket)) { // position is not in transposition table
             m->size++;
-            m->buckets[index] = (data){key, depth, n_of_pieces, best_move, quiescence, value}; 
-            return;
+            *bucket = (data){key, depth, n_of_pieces, best_move, quiescence, m->age, value};
+            return PUT_NEW;
         }
-        if (m->buckets[index].depth != -1 && n_of_pieces + depth - quiescence * 10 > m->buckets[index].n_of_pieces + m->buckets[index].depth + m->buckets[index].quiescence * 10) {
-            m->buckets[index] = (data){key, depth, n_of_pieces, best_move, quiescence, value}; // replace useless old entry
-            return;
+        if (bucket->key == key) { // position is already in transposition table
+            if (bucket->depth < depth) { // depth is bigger -> more accurate score -> swap
+                bucket->depth = depth;
+                bucket->score = value;
+                bucket->best_move = best_move;
+            }
+            bucket->age = m->age;
+            return PUT_UPDATED;
+        }
+        if (bucket->age != m->age) { // entry from an earlier turn of this game
+            if (bucket->n_of_pieces < m->root_pieces || bucket->depth <= depth) { // unreachable or shallower -> replace
+                *bucket = (data){key, depth, n_of_pieces, best_move, quiescence, m->age, value};
+                return PUT_REPLACED;
+            }
+        } else if (n_of_pieces + depth - quiescence * 10 > bucket->n_of_pieces + bucket->depth + bucket->quiescence * 10) {
+            *bucket = (data){key, depth, n_of_pieces, best_move, quiescence, m->age, value}; // replace useless old entry
+            return PUT_REPLACED;
         }
     }
+    return PUT_FULL;
 }
 
 // query transposition table for a search
 data* get_map(const Map *m, const Board *board) {
-    const uint32_t key = zobrist(board, &k);
+    return get_map_key(m, zobrist(board, &k));
+}
+
+// query transposition table for an already computed key
+data* get_map_key(const Map *m, const uint32_t key) {
     const unsigned int hkey = key % m->cap;
     const unsigned int hash2 = 11 - key % 11;
     for(int i = 0; i < m->cap; i++) {
         const unsigned int index = (hkey + i * hash2) % m->cap;
-        if(m->buckets[index].key == -1) break;
+        if(is_free(m, &m->buckets[index])) break;
         if(m->buckets[index].key == key) return &m->buckets[index];
     }
     return NULL;
 }
 
-// empty the transposition table
+// empty the transposition table (walks every bucket, use new_game_map between games)
 void empty_map(Map *m) {
     for (int i = 0; i < m->cap; i++) {
-        m->buckets[i] = (data){-1, -1, -1, -1, false, 0}; 
+        m->buckets[i] = (data){-1, -1, -1, -1, false, 0, 0}; 
     }
     m->size = 0;
+    m->age = 0;
+    m->game_age = 0;
 }
 
 // free allocated resources
 void free_map(const Map *m) {
     free(m->buckets);
-}
\ No newline at end of file
+}
+
+// allocate and initialize evaluation cache (cap must be a power of 2)
+EvalCache init_eval_cache(const int cap) {
+    EvalCache c = {cap, NULL};
+    c.buckets = malloc(sizeof(eval_entry) * c.cap);
+    empty_eval_cache(&c);
+    return c;
+}
+
+// query evaluation cache for a board key
+bool get_eval_cache(const EvalCache *c, const uint32_t key, const uint32_t check, int *score) {
+    const eval_entry *bucket = &c->buckets[key & (c->cap - 1)];
+    if (bucket->key != key || bucket->check != check || bucket->score == NO_SCORE) return false;
+    *score = bucket->score;
+    return true;
+}
+
+// store an evaluation, always replacing the previous occupant of the bucket
+void put_eval_cache(const EvalCache *c, const uint32_t key, const uint32_t check, const int score) {
+    c->buckets[key & (c->cap - 1)] = (eval_entry){key, check, score};
+}
+
+// empty the evaluation cache
+void empty_eval_cache(const EvalCache *c) {
+    for (int i = 0; i < c->cap; i++) {
+        c->buckets[i] = (eval_entry){0, 0, NO_SCORE};
+    }
+}
+
+// free allocated resources
+void free_eval_cache(const EvalCache *c) {
+    free(c->buckets);
+}
+
+// pack the non-key fields of an entry into one word
+static uint32_t pack_info(const int depth, const int n_of_pieces, const int best_move, const bool quiescence, const uint8_t age) {
+    return (uint8_t)depth | (uint32_t)(uint8_t)n_of_pieces << 8 | (uint32_t)(uint8_t)best_move << 16 |
+           (uint32_t)quiescence << 24 | (uint32_t)(age & MAX_AGE) << 25;
+}
+
+// read a shared entry, returns false if it is empty or was torn by a concurrent write
+static bool load_shared_entry(shared_entry *bucket, data *out) {
+    const uint32_t check = atomic_load_explicit(&bucket->check, memory_order_relaxed);
+    const uint32_t score = atomic_load_explicit(&bucket->score, memory_order_relaxed);
+    const uint32_t info = atomic_load_explicit(&bucket->info, memory_order_relaxed);
+    *out = (data){check ^ score ^ info, (int8_t)info, (int8_t)(info >> 8), (int8_t)(info >> 16), info >> 24 & 1, info >> 25, (int)score};
+    return out->depth != -1;
+}
+
+// write a shared entry, readers can see it half written but will then fail the key check
+static void store_shared_entry(shared_entry *bucket, const uint32_t key, const int value, const uint32_t info) {
+    atomic_store_explicit(&bucket->score, (uint32_t)value, memory_order_relaxed);
+    atomic_store_explicit(&bucket->info, info, memory_order_relaxed);
+    atomic_store_explicit(&bucket->check, key ^ (uint32_t)value ^ info, memory_order_relaxed);
+}
+
+// allocate and initialize lockless hashmap, buckets is NULL (and cap 0) when out of memory
+SharedMap init_shared_map(const int cap) {
+    SharedMap m = {cap, NULL, 0, 0};
+    m.buckets = malloc(sizeof(shared_entry) * m.cap);
+    if (m.buckets == NULL) m.cap = 0;
+    empty_shared_map(&m);
+    init_keys();
+    return m;
+}
+
+// put a new search into the shared transposition table
+void put_shared_map(SharedMap *m, const Board *board, const int value, const int depth, const int best_move, const bool quiescence) {
+    const uint32_t key = zobrist(board, &k);
+    const uint8_t age = atomic_load_explicit(&m->age, memory_order_relaxed);
+    const uint8_t game_age = atomic_load_explicit(&m->game_age, memory_order_relaxed);
+    const int n_of_pieces = count1s(board->black) + count1s(board->white);
+    shared_entry *victim = NULL;
+    int victim_value = INT_MAX;
+    for (int i = 0; i < SHARED_WAYS; i++) {
+        shared_entry *bucket = &m->buckets[(key + i) % m->cap];
+        data entry;
+        if (!load_shared_entry(bucket, &entry) || entry.age < game_age) { // empty or left over from a previous game
+            victim = bucket;
+            break;
+        }
+        if (entry.key == key) { // position is already in transposition table
+            if (entry.depth > depth) return; // keep the deeper search
+            victim = bucket;
+            break;
+        }
+        // prefer replacing entries from earlier searches, then shallower ones
+        const int value_of_entry = (entry.age == age) * 256 + entry.depth + entry.quiescence * 10;
+        if (value_of_entry < victim_value) {
+            victim = bucket;
+            victim_value = value_of_entry;
+        }
+    }
+    store_shared_entry(victim, key, value, pack_info(depth, n_of_pieces, best_move, quiescence, age));
+}
+
+// query shared transposition table for a search, copies the entry into out
+bool get_shared_map(SharedMap *m, const Board *board, data *out) {
+    const uint32_t key = zobrist(board, &k);
+    const uint8_t game_age = atomic_load_explicit(&m->game_age, memory_order_relaxed);
+    for (int i = 0; i < SHARED_WAYS; i++) {
+        if (load_shared_entry(&m->buckets[(key + i) % m->cap], out) && out->key == key && out->age >= game_age)
+            return true;
+    }
+    return false;
+}
+
+// start a new search in the shared transposition table
+void new_search_shared_map(SharedMap *m) {
+    uint_least8_t age = atomic_load_explicit(&m->age, memory_order_relaxed);
+    do { // the age may be moved on by another task between the check and the increment
+        if (age >= MAX_AGE) {
+            empty_shared_map(m); // out of ages, fall back to a full clear
+            return;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&m->age, &age, age + 1, memory_order_relaxed, memory_order_relaxed));
+}
+
+// start a new game: every stored entry becomes free without touching the buckets
+void new_game_shared_map(SharedMap *m) {
+    uint_least8_t age = atomic_load_explicit(&m->age, memory_order_relaxed);
+    do {
+        if (age >= MAX_AGE - 1) {
+            empty_shared_map(m); // out of ages, fall back to a full clear
+            return;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&m->age, &age, age + 1, memory_order_relaxed, memory_order_relaxed));
+    atomic_store_explicit(&m->game_age, age + 1, memory_order_relaxed);
+}
+
+// empty the shared transposition table (not safe while other tasks are searching)
+void empty_shared_map(SharedMap *m) {
+    for (int i = 0; i < m->cap; i++) {
+        store_shared_entry(&m->buckets[i], 0, 0, pack_info(-1, -1, -1, false, 0));
+    }
+    atomic_store_explicit(&m->age, 0, memory_order_relaxed);
+    atomic_store_explicit(&m->game_age, 0, memory_order_relaxed);
+}
+
+// free allocated resources
+void free_shared_map(const SharedMap *m) {
+    free(m->buckets);
+}
@@ -8,32 +8,101 @@
 #define HASHMAP_H
 
 #include <stdbool.h>
+#include <stdatomic.h>
 
 #include "Board.h"
 
 #define NO_SCORE -1163005939
 #define BASE 0x811c9dc5
 #define PRIME 0x01000193
+#define MAX_AGE 127 // ages are stored in 7 bits, the table is cleared when they run out
 
 typedef struct data {
     uint32_t key;
     int8_t depth;
     int8_t n_of_pieces;
     int8_t best_move;
-    bool quiescence;
+    uint8_t quiescence : 1;
+    uint8_t age : 7; // search that stored the entry
     int score;
 } data;
 
-typedef struct Map { int size; int cap; data *buckets; } Map;
+// outcome of a transposition table store
+typedef enum PutResult {
+    PUT_FULL,     // no bucket available, nothing stored
+    PUT_NEW,      // stored in a free bucket
+    PUT_UPDATED,  // the position was already stored
+    PUT_REPLACED, // another position was overwritten
+} PutResult;
+
+// age: current search, game_age: first search of the current game (older entries count as empty)
+// root_pieces: pieces on the board searched (entries with fewer pieces can't be reached again)
+typedef struct Map { int size; int cap; data *buckets; uint8_t age; uint8_t game_age; int root_pieces; } Map;
+
+// direct mapped cache of static evaluations (no depth or bounds, a board always has the same score)
+// check: second hash of the board, the bucket index only leaves 20 bits of the key to compare
+typedef struct eval_entry { uint32_t key; uint32_t check; int score; } eval_entry;
+
+typedef struct EvalCache { int cap; eval_entry *buckets; } EvalCache;
+
+// transposition table entry that can be shared between tasks/threads without locks:
+// check = key ^ score ^ info, so a torn write or read fails the key check and reads as a miss
+typedef struct shared_entry {
+    atomic_uint_least32_t check;
+    atomic_uint_least32_t score;
+    atomic_uint_least32_t info; // depth | n_of_pieces << 8 | best_move << 16 | quiescence << 24 | age << 25
+} shared_entry;
+
+#define SHARED_WAYS 4 // consecutive buckets a key can be stored in
+
+typedef struct SharedMap { int cap; shared_entry *buckets; atomic_uint_least8_t age; atomic_uint_least8_t game_age; } SharedMap;
+
+uint32_t hash_board(const Board *board);
+
+uint32_t canonical_hash_board(const Board *board, int *sym);
+
+uint32_t check_hash_board(const Board *board);
 
 Map init_map(int cap);
 
-void put_map(Map *m, const Board *board, int value, int depth, int best_move, bool quiescence);
+void new_search_map(Map *m, const Board *root);
+
+void new_game_map(Map *m);
+
+PutResult put_map(Map *m, const Board *board, int value, int depth, int best_move, bool quiescence);
+
+PutResult put_map_key(Map *m, uint32_t key, int n_of_pieces, int value, int depth, int best_move, bool quiescence);
 
 data* get_map(const Map *m, const Board *board);
 
+data* get_map_key(const Map *m, uint32_t key);
+
 void empty_map(Map *m);
 
 void free_map(const Map *m);
 
+EvalCache init_eval_cache(int cap);
+
+bool get_eval_cache(const EvalCache *c, uint32_t key, uint32_t check, int *score);
+
+void put_eval_cache(const EvalCache *c, uint32_t key, uint32_t check, int score);
+
+void empty_eval_cache(const EvalCache *c);
+
+void free_eval_cache(const EvalCache *c);
+
+SharedMap init_shared_map(int cap);
+
+void put_shared_map(SharedMap *m, const Board *board, int value, int depth, int best_move, bool quiescence);
+
+bool get_shared_map(SharedMap *m, const Board *board, data *out);
+
+void new_search_shared_map(SharedMap *m);
+
+void new_game_shared_map(SharedMap *m);
+
+void empty_shared_map(SharedMap *m);
+
+void free_shared_map(const SharedMap *m);
+
 #endif //HASHMAP_H
@@ -0,0 +1,90 @@
+//
+// nrf_frame.c
+// Developed by the GAME2 Team.
+// Packs messages for the PIC into radio frames and checks received frames (no ESP-IDF dependencies).
+//
+#include <string.h>
+
+#include "nrf_frame.h"
+
+// CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF), bitwise: frames are at most 30 bytes
+uint16_t nrf_crc16(const uint8_t *data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = crc & 0x8000 ? (uint16_t)(crc << 1) ^ 0x1021 : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+void nrf_frame_init(nrf_frame_t *frame) {
+    frame->length = 0;
+    frame->n_of_messages = 0;
+}
+
+bool nrf_frame_add(nrf_frame_t *frame, const nrf_message_t *message) {
+    if (message->length > NRF_MESSAGE_MAX_SIZE ||
+        frame->length + NRF_MESSAGE_HEADER_SIZE + message->length > NRF_FRAME_MAX_SIZE - NRF_FRAME_CRC_SIZE)
+        return false;
+    uint8_t *out = &frame->data[frame->length];
+    out[0] = message->type;
+    out[1] = message->seq;
+    out[2] = message->length;
+    memcpy(&out[NRF_MESSAGE_HEADER_SIZE], message->data, message->length);
+    frame->length += NRF_MESSAGE_HEADER_SIZE + message->length;
+    frame->n_of_messages++;
+    return true;
+}
+
+void nrf_frame_finish(nrf_frame_t *frame) {
+    const uint16_t crc = nrf_crc16(frame->data, frame->length);
+    frame->data[frame->length++] = crc & 0xFF;
+    frame->data[frame->length++] = crc >> 8;
+}
+
+int nrf_frame_parse(const uint8_t *data, size_t length, nrf_message_t *messages, int max_messages) {
+    if (length < NRF_FRAME_CRC_SIZE + NRF_MESSAGE_HEADER_SIZE || length > NRF_FRAME_MAX_SIZE) return -1;
+    length -= NRF_FRAME_CRC_SIZE;
+    if (nrf_crc16(data, length) != (data[length] | data[length + 1] << 8)) return -1;
+    int n = 0;
+    for (size_t i = 0; i < length; n++) {
+        if (n == max_messages || length - i < NRF_MESSAGE_HEADER_SIZE ||
+            data[i + 2] > length - i - NRF_MESSAGE_HEADER_SIZE) return -1;
+        messages[n].type = data[i];
+        messages[n].seq = data[i + 1];
+        messages[n].length = data[i + 2];
+        memcpy(messages[n].data, &data[i + NRF_MESSAGE_HEADER_SIZE], messages[n].length);
+        i += NRF_MESSAGE_HEADER_SIZE + messages[n].length;
+    }
+    return n;
+}
+
+void nrf_rx_state_init(nrf_rx_state_t *state) {
+    for (int type = 0; type < NRF_MSG_TYPES; type++) state->last_seq[type] = -1;
+    state->boot_id = 0;
+    state->has_boot_id = false;
+}
+
+bool nrf_rx_accept(nrf_rx_state_t *state, const nrf_message_t *message) {
+    if (message->type == NRF_MSG_RESTART) {
+        if (message->length < NRF_RESTART_LENGTH) return false;
+        const uint32_t boot_id = message->data[0] | message->data[1] << 8 | message->data[2] << 16 |
+                                 (uint32_t)message->data[3] << 24;
+        if (state->has_boot_id && boot_id == state->boot_id) return false; // repeated until acknowledged
+        nrf_rx_state_init(state);
+        state->boot_id = boot_id;
+        state->has_boot_id = true;
+        return true;
+    }
+    if (message->type >= NRF_MSG_TYPES) return true;
+    int16_t *last = &state->last_seq[message->type];
+    if (*last >= 0 && (int8_t)(message->seq - (uint8_t)*last) <= 0) return false; // serial number arithmetic
+    *last = message->seq;
+    return true;
+}
+
+nrf_message_t nrf_restart_message(const uint32_t boot_id) {
+    return (nrf_message_t){.type = NRF_MSG_RESTART, .length = NRF_RESTART_LENGTH,
+                           .data = {boot_id & 0xFF, boot_id >> 8 & 0xFF, boot_id >> 16 & 0xFF, boot_id >> 24}};
+}
@@ -0,0 +1,56 @@
+//
+// profile.c
+// Developed by the GAME2 Team.
+//
+#include "profile.h"
+
+#ifdef GOMOKU_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(ESP_PLATFORM) && !defined(__x86_64__) && !defined(__i386__)
+#include <time.h>
+
+profile_ticks_t profile_ticks() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (profile_ticks_t)t.tv_sec * 1000000000u + t.tv_nsec;
+}
+#define PROFILE_UNIT "ns"
+#else
+#define PROFILE_UNIT "cycles"
+#endif
+
+static uint64_t phase_ticks[N_OF_PROFILE_PHASES];
+static uint32_t phase_calls[N_OF_PROFILE_PHASES];
+
+static const char* phase_names[N_OF_PROFILE_PHASES] = {
+    "search", "t_table probe", "t_table store", "win check", "evaluation", "move generation", "move scoring", "quiescence"
+};
+
+// adds one call of a phase
+void profile_add(const ProfilePhase phase, const profile_ticks_t ticks) {
+    phase_ticks[phase] += ticks;
+    phase_calls[phase]++;
+}
+
+// clears every phase (called at the start of every search)
+void reset_profile() {
+    memset(phase_ticks, 0, sizeof(phase_ticks));
+    memset(phase_calls, 0, sizeof(phase_calls));
+}
+
+// prints ticks per phase, per call and as share of the whole search
+void print_profile() {
+    const uint64_t total = phase_ticks[PROFILE_SEARCH];
+    printf("%-16s %10s %14s %10s %7s\n", "phase", "calls", PROFILE_UNIT, "per call", "search");
+    for (int phase = 0; phase < N_OF_PROFILE_PHASES; phase++) {
+        if (phase_calls[phase] == 0) continue;
+        printf("%-16s %10lu %14llu %10llu %6.1f%%\n", phase_names[phase], (unsigned long)phase_calls[phase],
+               (unsigned long long)phase_ticks[phase], (unsigned long long)(phase_ticks[phase] / phase_calls[phase]),
+               total > 0 ? 100.0 * (double)phase_ticks[phase] / (double)total : 0);
+    }
+}
+
+#endif //GOMOKU_PROFILE
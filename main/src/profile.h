@@ -0,0 +1,72 @@
+//
+// profile.h
+// Developed by the GAME2 Team.
+// Compile-time optional hot path profiler: cycles and calls per engine phase.
+// Enabled by GOMOKU_PROFILE (CONFIG_GOMOKU_PROFILE on the device), otherwise every macro is empty.
+//
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#if defined(CONFIG_GOMOKU_PROFILE) && !defined(GOMOKU_PROFILE)
+#define GOMOKU_PROFILE
+#endif
+#endif
+
+// phases are inclusive: move generation contains move scoring, quiescence contains everything it calls
+typedef enum ProfilePhase {
+    PROFILE_SEARCH,          // whole bot_search
+    PROFILE_T_T_PROBE,       // key computation and transposition table query
+    PROFILE_T_T_STORE,       // transposition table store
+    PROFILE_WIN_CHECK,       // check_winner in minimax
+    PROFILE_EVALUATION,      // evaluate_board (evaluation cache and static evaluation)
+    PROFILE_MOVE_GENERATION, // find_next_moves
+    PROFILE_MOVE_SCORING,    // evaluate_move
+    PROFILE_QUIESCENCE,      // quiescence searches started by minimax
+    N_OF_PROFILE_PHASES
+} ProfilePhase;
+
+#ifdef GOMOKU_PROFILE
+
+#if defined(ESP_PLATFORM)
+#include "esp_cpu.h"
+typedef uint32_t profile_ticks_t; // CPU cycles, differences stay correct across the 32 bit wrap
+#define profile_ticks() esp_cpu_get_cycle_count()
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+typedef uint64_t profile_ticks_t; // time stamp counter cycles
+#define profile_ticks() __rdtsc()
+#else
+typedef uint64_t profile_ticks_t; // nanoseconds
+profile_ticks_t profile_ticks();
+#endif
+
+void profile_add(ProfilePhase phase, profile_ticks_t ticks);
+
+void reset_profile();
+
+void print_profile();
+
+#define PROFILE_BEGIN(phase) const profile_ticks_t profile_start_##phase = profile_ticks()
+#define PROFILE_END(phase) profile_add(phase, (profile_ticks_t)(profile_ticks() - profile_start_##phase))
+#define PROFILE_START(start) ((start) = profile_ticks()) // for phases that span calls, start is kept by the caller
+#define PROFILE_STOP(phase, start) profile_add(phase, (profile_ticks_t)(profile_ticks() - (start)))
+#define PROFILE_RESET() reset_profile()
+#define PROFILE_PRINT() print_profile()
+
+#else
+
+#define PROFILE_BEGIN(phase)
+#define PROFILE_END(phase)
+#define PROFILE_START(start)
+#define PROFILE_STOP(phase, start)
+#define PROFILE_RESET()
+#define PROFILE_PRINT()
+
+#endif //GOMOKU_PROFILE
+
+#endif //PROFILE_H
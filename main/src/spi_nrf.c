@@ -21,17 +21,21 @@
 
 #include <string.h>
 #include "spi_nrf.h"
+#include "nrf_frame.h"
+#include "dlog.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_random.h"
 #include <unistd.h>
 #include "esp_log.h"
 #include <sys/param.h>
 
 #define NRF_BUSY_TIMEOUT_MS  5
 
-#define NRF_CLK_FREQ         (1000000)   //When powered by 3.3V, nrf max freq is 1MHz
+#define NRF_CLK_FREQ         SPI_CLOCK_SPEED
 #define NRF_INPUT_DELAY_NS   ((1000000000/NRF_CLK_FREQ)/2+20)
 
 #define ADDR_MASK   0x7f
@@ -50,11 +54,41 @@
 #define ADD_ERAL    0x40
 #define ADD_EWEN    0x60
 
+#define NRF_PAYLOAD_SIZE       32
+#define NRF_SPI_QUEUE_SIZE     7    // transactions in flight for queued register writes
+#define NRF_REGISTER_MAX_SIZE  5    // address registers
+#define NRF_CONFIG_RX          0x3F // PRIM_RX, PWR_UP, CRC, TX_DS and MAX_RT masked
+#define NRF_CONFIG_TX          0x0E // PWR_UP, CRC, TX_DS and MAX_RT raise the IRQ line
+#define NRF_STATUS_RX_DR       (1 << 6)
+#define NRF_STATUS_TX_DS       (1 << 5)
+#define NRF_STATUS_MAX_RT      (1 << 4)
+#define NRF_FIFO_RX_EMPTY      (1 << 0)
+#define NRF_FEATURE_EN_DPL     (1 << 2)
+#define NRF_FEATURE_EN_ACK_PAY (1 << 1)
+#define NRF_DYNPD_P0           (1 << 0)
+#define NRF_ACTIVATE_FEATURES  0x73 // ACTIVATE data unlocking FEATURE on the nRF24L01 (ignored by the +)
+#define NRF_TX_QUEUE_LEN       16   // messages, a frame packs the queued ones that fit
+#define NRF_TX_ATTEMPTS        6   // transmissions (each with the chip's auto retransmits) before giving up
+#define NRF_TX_IRQ_TIMEOUT_MS  20  // a transmission with all auto retransmits takes a few ms
+#define NRF_BACKOFF_MIN_MS     10  // wait after the first failed transmission, doubled after every failure
+#define NRF_BACKOFF_MAX_MS     320
+#define NRF_RADIO_TASK_STACK   3072
+#define NRF_RADIO_TASK_PRIORITY 6  // above the search and NimBLE host tasks, it mostly waits (interrupt latency)
+
 spi_device_handle_t spi;
 
+// the radio task owns the radio: it is woken by the IRQ line and by nrf_send_message
+static TaskHandle_t nrf_radio_task_handle;
+static QueueHandle_t nrf_tx_queue;  // nrf_message_t
+static nrf_rx_state_t nrf_rx_state; // seqs of the PIC's messages
+static nrf_message_t nrf_restart;   // heads the frames until the PIC acknowledged one
+static bool nrf_restart_pending;
+static nrf_tx_callback_t nrf_tx_callback = NULL;
+static nrf_rx_callback_t nrf_rx_callback = NULL;
+
 void nrf_gpio_init() {
     gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << NRF_CE_PIN) | (1ULL << NRF_CSN_PIN),
+        .pin_bit_mask = (1ULL << NRF_CE_PIN), // CSN is driven by the SPI peripheral
         .mode = GPIO_MODE_OUTPUT,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
         .pull_up_en = GPIO_PULLUP_DISABLE,
@@ -63,91 +97,79 @@ void nrf_gpio_init() {
     gpio_config(&io_conf);
 
     gpio_set_level(NRF_CE_PIN, 0);   // make ce low by default
-    gpio_set_level(NRF_CSN_PIN, 1); // make csn high by default
+}
+
+// one SPI transaction: the command byte, then length data bytes (tx NULL sends NOPs), CSN is low for
+// the whole transaction. Returns STATUS, which the nRF24 shifts out during the command byte
+static uint8_t nrf_command(uint8_t cmd, const uint8_t *tx, uint8_t *rx, size_t length) {
+    length = MIN(length, NRF_PAYLOAD_SIZE);
+    spi_transaction_t t = {.length = (length + 1) * 8};
+    uint8_t tx_data[NRF_PAYLOAD_SIZE + 1], rx_data[NRF_PAYLOAD_SIZE + 1];
+    if (length < 4) { // register operations fit in the transaction itself
+        t.flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_USE_RXDATA;
+    } else {
+        t.tx_buffer = tx_data;
+        t.rx_buffer = rx_data;
+    }
+    uint8_t *out = length < 4 ? t.tx_data : tx_data;
+    out[0] = cmd;
+    if (tx != NULL) memcpy(&out[1], tx, length);
+    else memset(&out[1], 0xFF, length);
+    spi_device_polling_transmit(spi, &t); // a few us, cheaper than sleeping on the SPI interrupt
+    const uint8_t *in = length < 4 ? t.rx_data : rx_data;
+    if (rx != NULL) memcpy(rx, &in[1], length);
+    return in[0];
 }
 
 void nrf_write_register(uint8_t reg, uint8_t value) {
-    uint8_t tx_data[2] = { NRF_CMD_W_REGISTER | reg, value };
-    spi_transaction_t t = {
-        .length = 16,
-        .tx_buffer = tx_data,
-    };
-    gpio_set_level(NRF_CSN_PIN, 0); // make CSN low to strat transmiting data
-    spi_device_transmit(spi, &t);
-    gpio_set_level(NRF_CSN_PIN, 1); // make CSN low to end transmision
+    nrf_command(NRF_CMD_W_REGISTER | reg, &value, NULL, 1);
 }
 
 void nrf_write_register_multi(uint8_t reg, uint8_t *data, size_t length) {
-    uint8_t tx_data[length + 1];
-    tx_data[0] = NRF_CMD_W_REGISTER | reg;
-    memcpy(&tx_data[1], data, length);
-    spi_transaction_t t = {
-        .length = (length + 1) * 8,
-        .tx_buffer = tx_data,
-    };
-    gpio_set_level(NRF_CSN_PIN, 0); // make CSN low to strat transmiting data
-    spi_device_transmit(spi, &t);
-    gpio_set_level(NRF_CSN_PIN, 1); // make CSN low to end transmision
+    nrf_command(NRF_CMD_W_REGISTER | reg, data, NULL, length);
 }
 
 void nrf_write_payload(uint8_t *data, size_t length) {
-    uint8_t cmd = NRF_CMD_W_TX_PAYLOAD;
-    spi_transaction_t t = {
-        .length = 8,
-        .tx_buffer = &cmd,
-    };
-    gpio_set_level(NRF_CSN_PIN, 0); // make CSN low to strat transmiting data
-    spi_device_transmit(spi, &t);  //  transmit the send payload instruction
-    t.length = length * 8;
-    t.tx_buffer = data;
-    spi_device_transmit(spi, &t);  // send data to another nrf24
-    gpio_set_level(NRF_CSN_PIN, 1); // make CSN low to end transmision
+    nrf_command(NRF_CMD_W_TX_PAYLOAD, data, NULL, length); // send data to another nrf24
 }
 
 void nrf_read_payload(uint8_t *data, size_t length) {
-    uint8_t cmd = NRF_CMD_R_RX_PAYLOAD;
-    spi_transaction_t t = {
-        .length = 8,
-        .tx_buffer = &cmd,
-    };
-    gpio_set_level(NRF_CSN_PIN, 0); // make CSN low to strat transmiting data
-    spi_device_transmit(spi, &t);  // transmit the send payload instruction
-    t.length = length * 8;
-    t.tx_buffer = NULL;
-    t.rx_buffer = data;
-    spi_device_transmit(spi, &t);  // read data from nrf24
-    gpio_set_level(NRF_CSN_PIN, 1); // make CSN low to end transmision
+    nrf_command(NRF_CMD_R_RX_PAYLOAD, NULL, data, length); // read data from nrf24
 }
 
 uint8_t nrf_read_register(uint8_t reg) {
-    uint8_t tx_data[2] = { NRF_CMD_R_REGISTER | reg, 0xFF };
-    uint8_t rx_data[2] = {0};
-    spi_transaction_t t = {
-        .length = 16,
-        .tx_buffer = tx_data,
-        .rx_buffer = rx_data,
-    };
-    gpio_set_level(NRF_CSN_PIN, 0); 
-    spi_device_transmit(spi, &t);
-    gpio_set_level(NRF_CSN_PIN, 1); 
-    return rx_data[1];
+    uint8_t value;
+    nrf_command(NRF_CMD_R_REGISTER | reg, NULL, &value, 1);
+    return value;
 }
 
 void nrf_read_register_multi(uint8_t reg, uint8_t *data, size_t length) {
-    uint8_t tx_data = NRF_CMD_R_REGISTER | reg; // do or operation to read register command code and register address
-    spi_transaction_t t = {
-        .length = 8,           
-        .tx_buffer = &tx_data, 
-    };
-
-    gpio_set_level(NRF_CSN_PIN, 0); 
-    spi_device_transmit(spi, &t);  
+    nrf_command(NRF_CMD_R_REGISTER | reg, NULL, data, length);
+}
 
-    t.length = length * 8;  // prepare to receive length bytes's data
-    t.tx_buffer = NULL;    
-    t.rx_buffer = data;     
-    spi_device_transmit(spi, &t);  
-    gpio_set_level(NRF_CSN_PIN, 1); 
+// register value for nrf_write_registers
+typedef struct {
+    uint8_t reg;
+    uint8_t length;
+    uint8_t value[NRF_REGISTER_MAX_SIZE];
+} nrf_register_value_t;
+
+// writes several registers back to back: the transactions are queued and waited for together
+static void nrf_write_registers(const nrf_register_value_t *values, size_t n) {
+    spi_transaction_t t[NRF_SPI_QUEUE_SIZE];
+    uint8_t tx_data[NRF_SPI_QUEUE_SIZE][NRF_REGISTER_MAX_SIZE + 1];
+    for (size_t i = 0; i < n; i += NRF_SPI_QUEUE_SIZE) {
+        const size_t batch = MIN(n - i, NRF_SPI_QUEUE_SIZE);
+        for (size_t j = 0; j < batch; j++) {
+            const nrf_register_value_t *v = &values[i + j];
+            tx_data[j][0] = NRF_CMD_W_REGISTER | v->reg;
+            memcpy(&tx_data[j][1], v->value, v->length);
+            t[j] = (spi_transaction_t){.length = (v->length + 1) * 8, .tx_buffer = tx_data[j]};
+            spi_device_queue_trans(spi, &t[j], portMAX_DELAY);
+        }
+        spi_transaction_t *done;
+        for (size_t j = 0; j < batch; j++) spi_device_get_trans_result(spi, &done, portMAX_DELAY);
+    }
 }
 
 void spi_init() {
@@ -157,34 +179,52 @@ void spi_init() {
         .sclk_io_num = GPIO_NUM_13,
         .quadwp_io_num = -1,
         .quadhd_io_num = -1,
-        .max_transfer_sz = 32,
+        .max_transfer_sz = NRF_PAYLOAD_SIZE + 1, // command and payload
     };
     spi_device_interface_config_t devcfg = {
         .clock_speed_hz = SPI_CLOCK_SPEED,
         .mode = 0, 
-        .spics_io_num = -1,//< CS GPIO pin for this device, or -1 if not used
-        .queue_size = 7,
+        .spics_io_num = NRF_CSN_PIN, // hardware CS, low for each whole transaction
+        .queue_size = NRF_SPI_QUEUE_SIZE,
     };
 
-    spi_bus_initialize(SPI_HOST, &buscfg, SPI_DMA_CH_AUTO);
+    // transactions are at most 33 bytes, the CPU fills the FIFO faster than setting up DMA
+    spi_bus_initialize(SPI_HOST, &buscfg, SPI_DMA_DISABLED);
     spi_bus_add_device(SPI_HOST, &devcfg, &spi);
 }
 
+static void nrf_radio_task(void *param);
+
 void nrf_init() {
     nrf_gpio_init(); // configure GPIO
     spi_init();      // configure SPI
 
-    nrf_write_register(NRF_REG_CONFIG, 0x3F);   //enable interrupt for receiving. enable CRC, and set to receive mode
-    nrf_write_register(NRF_REG_RF_SETUP, 0x06); // set RF output power to 0 dbm
-    nrf_write_register(NRF_REG_RF_CH, 0x10);    // set RF frequency 0x61
-
+    // ACTIVATE toggles FEATURE and DYNPD on the original nRF24L01: after a reset of the ESP32 alone they are still
+    // active, and a second ACTIVATE would lock them. Only sent when a FEATURE write doesn't stick
+    const uint8_t features = NRF_FEATURE_EN_DPL | NRF_FEATURE_EN_ACK_PAY;
+    nrf_write_register(NRF_REG_FEATURE, features);
+    if (nrf_read_register(NRF_REG_FEATURE) != features)
+        nrf_command(NRF_CMD_ACTIVATE, (const uint8_t[]){NRF_ACTIVATE_FEATURES}, NULL, 1);
     // uint8_t tx_address[5] = { 0xE7, 0xC9, 0x3F, 0x03, 0x00 }; // 
-    uint8_t tx_address[5] = { 0x00, 0x00, 0x00, 0x00, 0x01 }; // set tx address
-    nrf_write_register_multi(NRF_REG_TX_ADDR, tx_address, 5);
-    nrf_write_register_multi(NRF_REG_RX_ADDR_P0, tx_address, 5); // set rx0 address to the same as transmit address for auto acknowledgement
-
-    nrf_write_register(NRF_REG_EN_AA, 0x01); // enable auto acknowledgement for pipe 0
-    nrf_write_register(NRF_REG_RX_PW_P0, 0x20); // receive byte is 32 bytes
+    static const nrf_register_value_t config[] = {
+        {NRF_REG_CONFIG, 1, {NRF_CONFIG_RX}},   //enable interrupt for receiving. enable CRC, and set to receive mode
+        {NRF_REG_RF_SETUP, 1, {0x06}},          // set RF output power to 0 dbm
+        {NRF_REG_RF_CH, 1, {0x10}},             // set RF frequency 0x61
+        {NRF_REG_TX_ADDR, 5, {0x00, 0x00, 0x00, 0x00, 0x01}},    // set tx address
+        {NRF_REG_RX_ADDR_P0, 5, {0x00, 0x00, 0x00, 0x00, 0x01}}, // set rx0 address to the same as transmit address for auto acknowledgement
+        {NRF_REG_EN_AA, 1, {0x01}},             // enable auto acknowledgement for pipe 0
+        // frames have their own length (dynamic payload length), the PIC answers with a frame in the ACK
+        {NRF_REG_FEATURE, 1, {NRF_FEATURE_EN_DPL | NRF_FEATURE_EN_ACK_PAY}}, // again, after ACTIVATE
+        {NRF_REG_DYNPD, 1, {NRF_DYNPD_P0}},
+    };
+    nrf_write_registers(config, sizeof(config) / sizeof(config[0]));
+    gpio_set_level(NRF_CE_PIN, 1); // listen for the PIC before the first transmission
+
+    nrf_rx_state_init(&nrf_rx_state);
+    nrf_restart = nrf_restart_message(esp_random());
+    nrf_restart_pending = true;
+    nrf_tx_queue = xQueueCreate(NRF_TX_QUEUE_LEN, sizeof(nrf_message_t));
+    xTaskCreate(nrf_radio_task, "radio", NRF_RADIO_TASK_STACK, NULL, NRF_RADIO_TASK_PRIORITY, &nrf_radio_task_handle);
 }
 
 void nrf_clear_tx_rx(void) {
@@ -196,41 +236,151 @@ void nrf_clear_interrupts() {
     nrf_write_register(NRF_REG_STATUS, 0x7E);
 }
 
-void nrf_send_data(uint8_t *data, size_t length) {
-    while (1) {//continuously send data
-        uint8_t full_data[32];
-        memset(full_data, 0, sizeof(full_data)); // configure the sending buffer to 0
-        memcpy(full_data, data, length);         // copy data 
-
-        nrf_write_register(NRF_REG_CONFIG, 0x3E);        // to TX mode
-        gpio_set_level(NRF_CE_PIN, 0);                   // Pull up CE to transmit; Mask TX_DS and MAX_RT
-        nrf_write_payload(full_data, sizeof(full_data)); // write 32 bytes payload
-
-        gpio_set_level(NRF_CE_PIN, 1); 
-        vTaskDelay(1);                 
-        gpio_set_level(NRF_CE_PIN, 0); 
-        uint8_t status = 0;
-        status = nrf_read_register(NRF_REG_STATUS);
-        printf("STATUS: 0x%02X\n", status);
-
-        if (status & (1 << 5)) { //check whether the data sent successfully. when there is data in its buffer, the interrupt flag will be set to high
-            printf("Data sent successfully!\n");
-            nrf_write_register(NRF_REG_CONFIG, 0x3F); // to RX mode
-            gpio_set_level(NRF_CE_PIN, 1);
-            nrf_write_register(NRF_REG_STATUS, 0x70);
-            nrf_clear_tx_rx();
+// hands the messages of a received frame to the receive callback, a message already received (its seq isn't after
+// the last one of its type: resent by the PIC, or repeated in its ACK payloads) is dropped
+static void nrf_deliver(const uint8_t *payload, size_t length) {
+    nrf_message_t messages[NRF_FRAME_MAX_MESSAGES];
+    const int n = nrf_frame_parse(payload, length, messages, NRF_FRAME_MAX_MESSAGES);
+    if (n < 0) {
+        DLOG_W("nrf", "invalid frame (%u bytes) dropped", (unsigned)length);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        const nrf_message_t *message = &messages[i];
+        if (!nrf_rx_accept(&nrf_rx_state, message)) continue;
+        if (message->type == NRF_MSG_RESTART) DLOG_I("nrf", "the PIC restarted");
+        if (nrf_rx_callback != NULL) nrf_rx_callback(message);
+    }
+}
+
+// reads every received frame (the RX FIFO holds up to 3)
+static void nrf_receive() {
+    nrf_write_register(NRF_REG_STATUS, NRF_STATUS_RX_DR); // before reading, so a later payload raises the IRQ again
+    while (!(nrf_read_register(NRF_REG_FIFO_STATUS) & NRF_FIFO_RX_EMPTY)) {
+        uint8_t width;
+        nrf_command(NRF_CMD_R_RX_PL_WID, NULL, &width, 1);
+        if (width == 0 || width > NRF_PAYLOAD_SIZE) { // corrupt, the datasheet says flush
+            nrf_write_register(NRF_CMD_FLUSH_RX, 0);
             break;
-        } else if (status & (1 << 4)) { //reach the max resend time
-            printf("Max retransmission reached. Flushing TX.\n");
-            nrf_write_register(NRF_CMD_FLUSH_TX, 0); // flush send queue
-        } else {
-            printf("Data not sent :(\n");
         }
+        uint8_t payload[NRF_PAYLOAD_SIZE];
+        nrf_read_payload(payload, width);
+        nrf_deliver(payload, width);
+    }
+}
+
+// waits ms, serving received payloads in the meantime
+static void nrf_wait(const uint32_t ms) {
+    const TickType_t end = xTaskGetTickCount() + MAX(pdMS_TO_TICKS(ms), 1);
+    TickType_t now;
+    while ((int32_t)(end - (now = xTaskGetTickCount())) > 0) {
+        ulTaskNotifyTake(pdTRUE, end - now);
+        nrf_receive();
+    }
+}
+
+// transmits one frame and waits for TX_DS or MAX_RT on the IRQ line, returns STATUS
+static uint8_t nrf_transmit(nrf_frame_t *frame) {
+    nrf_write_register(NRF_REG_CONFIG, NRF_CONFIG_TX); // to TX mode
+    gpio_set_level(NRF_CE_PIN, 0);
+    nrf_write_payload(frame->data, frame->length);     // sent with its length (DPL)
+    gpio_set_level(NRF_CE_PIN, 1);                     // transmit until the IRQ
+    const TickType_t start = xTaskGetTickCount(), timeout = MAX(pdMS_TO_TICKS(NRF_TX_IRQ_TIMEOUT_MS), 1);
+    TickType_t waited = 0;
+    uint8_t status;
+    do { // other notifications (queued payloads) can wake the task first, it then waits for the rest of the timeout
+        ulTaskNotifyTake(pdTRUE, timeout - waited);
+        status = nrf_read_register(NRF_REG_STATUS); // read even on timeout, the IRQ may be lost
+    } while (!(status & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT)) && (waited = xTaskGetTickCount() - start) < timeout);
+    gpio_set_level(NRF_CE_PIN, 0);
+
+    if (!(status & NRF_STATUS_TX_DS)) nrf_write_register(NRF_CMD_FLUSH_TX, 0); // flush send queue
+    nrf_write_register(NRF_REG_STATUS, NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+    nrf_write_register(NRF_REG_CONFIG, NRF_CONFIG_RX); // back to RX mode
+    gpio_set_level(NRF_CE_PIN, 1);
+    // the ACK payload (RX_DR with TX_DS) is in the RX FIFO, and a notification for a payload received
+    // before the transmission may have been consumed
+    nrf_receive();
+    return status;
+}
+
+// sends a frame, retrying with exponential backoff, and reports the delivery of its messages.
+// Retries resend the same seqs, so the PIC applies each message once even when only the ACK was lost
+static void nrf_send(nrf_frame_t *frame, const nrf_message_t *messages) {
+    bool delivered = false;
+    uint32_t backoff_ms = NRF_BACKOFF_MIN_MS;
+    for (int attempt = 1; attempt <= NRF_TX_ATTEMPTS; attempt++) {
+        const uint8_t status = nrf_transmit(frame);
+        if (status & NRF_STATUS_TX_DS) {
+            delivered = true;
+            break;
+        }
+        DLOG_W("nrf", "transmission %d failed (STATUS 0x%02X), retry in %u ms", attempt, status, (unsigned)backoff_ms);
+        if (attempt == NRF_TX_ATTEMPTS) break;
+        nrf_wait(backoff_ms);
+        backoff_ms = MIN(backoff_ms * 2, NRF_BACKOFF_MAX_MS);
+    }
+    if (delivered) DLOG_I("nrf", "Data sent successfully!");
+    else DLOG_E("nrf", "frame not delivered after %d transmissions", NRF_TX_ATTEMPTS);
+    if (delivered) nrf_restart_pending = false;
+    for (int i = 0; i < frame->n_of_messages; i++)
+        if (nrf_tx_callback != NULL && messages[i].type != NRF_MSG_RESTART) nrf_tx_callback(&messages[i], delivered);
+}
+
+// packs the queued messages that fit in one frame, after the restart message until the PIC has it.
+// Returns false when the queue is empty
+static bool nrf_next_frame(nrf_frame_t *frame, nrf_message_t *messages) {
+    nrf_frame_init(frame);
+    if (nrf_restart_pending) {
+        messages[0] = nrf_restart;
+        nrf_frame_add(frame, &messages[0]);
+    }
+    const int n_of_restarts = frame->n_of_messages;
+    while (frame->n_of_messages < NRF_FRAME_MAX_MESSAGES &&
+           xQueuePeek(nrf_tx_queue, &messages[frame->n_of_messages], 0) == pdTRUE &&
+           nrf_frame_add(frame, &messages[frame->n_of_messages]))
+        xQueueReceive(nrf_tx_queue, &messages[frame->n_of_messages - 1], 0);
+    if (frame->n_of_messages == n_of_restarts) return false;
+    nrf_frame_finish(frame);
+    return true;
+}
+
+// long-lived radio task: serves every interrupt (bursts included) and the transmit queue
+static void nrf_radio_task(void *param) {
+    nrf_frame_t frame;
+    nrf_message_t messages[NRF_FRAME_MAX_MESSAGES];
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        nrf_receive();
+        while (nrf_next_frame(&frame, messages)) nrf_send(&frame, messages);
+    }
+}
 
-        nrf_write_register(NRF_REG_STATUS, 0x70);
-        nrf_clear_tx_rx();
-        vTaskDelay(pdMS_TO_TICKS(1000));
+bool nrf_send_message(const nrf_message_t *message) {
+    if (message->length > NRF_MESSAGE_MAX_SIZE) {
+        DLOG_E("nrf", "message of %d bytes doesn't fit in a frame", message->length);
+        return false;
+    }
+    if (xQueueSend(nrf_tx_queue, message, 0) != pdTRUE) {
+        DLOG_E("nrf", "radio queue full, message dropped");
+        return false;
     }
+    xTaskNotifyGive(nrf_radio_task_handle);
+    return true;
+}
+
+void nrf_set_tx_callback(nrf_tx_callback_t callback) {
+    nrf_tx_callback = callback;
+}
+
+void nrf_set_rx_callback(nrf_rx_callback_t callback) {
+    nrf_rx_callback = callback;
+}
+
+void IRAM_ATTR nrf_irq_from_isr() {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(nrf_radio_task_handle, &woken);
+    portYIELD_FROM_ISR(woken);
 }
 
 void nrf_check_configuration(void) {
@@ -0,0 +1,105 @@
+//
+// trace.c
+// Developed by the GAME2 Team.
+//
+#include "trace.h"
+
+#ifdef GOMOKU_TRACE
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bot.h"
+
+#define MAX_TRACE_LEVEL (MAX_PLY + 1) // quiescence searches start at the ply of their minimax node
+
+// node being searched at every level of the recursion
+typedef struct TraceFrame {
+    TraceRecord record;
+    uint32_t start_nodes;
+} TraceFrame;
+
+static TraceFrame frames[MAX_TRACE_LEVEL];
+static int level = 0;
+static TraceRecord ring[TRACE_RING_RECORDS];
+static uint32_t written = 0; // records written to the ring since the last reset
+static FILE* trace_file = NULL;
+int trace_next_move = -1; // move played to reach the next node entered
+
+// starts the record of a node
+void trace_enter(const int alpha, const int beta, const int depth, const int ply, const uint8_t flags) {
+    TraceFrame* frame = &frames[level++];
+    frame->start_nodes = search_stats.nodes;
+    frame->record = (TraceRecord){.alpha = alpha, .beta = beta, .depth = (int8_t)depth, .ply = (uint8_t)ply,
+                                  .move = (int8_t)trace_next_move, .best_move = -1, .flags = flags};
+    trace_next_move = -1;
+}
+
+static TraceRecord* current() {
+    return &frames[level - 1].record;
+}
+
+void trace_key(const uint32_t key) { current()->key = key; }
+
+void trace_flag(const uint8_t flag) { current()->flags |= flag; }
+
+void trace_moves(const int n_of_moves) { current()->n_of_moves = (uint8_t)n_of_moves; }
+
+void trace_searched(const int searched) { current()->searched = (uint8_t)searched; }
+
+void trace_best(const int move) { current()->best_move = (int8_t)move; }
+
+// finishes the record of a node and writes it to the file or the ring buffer
+void trace_exit(const int result, const bool aborted) {
+    TraceFrame* frame = &frames[--level];
+    TraceRecord* record = &frame->record;
+    record->result = result;
+    record->nodes = search_stats.nodes - frame->start_nodes;
+    if (aborted) record->flags |= TRACE_ABORTED;
+    if (trace_file != NULL) fwrite(record, sizeof(*record), 1, trace_file);
+    else ring[written++ & (TRACE_RING_RECORDS - 1)] = *record;
+}
+
+// streams records to a file instead of the ring buffer, returns false if it can't be created
+bool trace_open(const char* path) {
+    trace_close();
+    trace_file = fopen(path, "wb");
+    if (trace_file == NULL) return false;
+    const TraceHeader header = {.magic = TRACE_MAGIC, .version = TRACE_VERSION, .record_size = sizeof(TraceRecord)};
+    fwrite(&header, sizeof(header), 1, trace_file);
+    return true;
+}
+
+void trace_close() {
+    if (trace_file != NULL) fclose(trace_file);
+    trace_file = NULL;
+}
+
+// records in the ring buffer, oldest at index *first (wrapping), returns their number
+int trace_ring(const TraceRecord** records, int* first) {
+    *records = ring;
+    *first = written > TRACE_RING_RECORDS ? (int)(written & (TRACE_RING_RECORDS - 1)) : 0;
+    return written > TRACE_RING_RECORDS ? TRACE_RING_RECORDS : (int)written;
+}
+
+// prints the ring buffer as "TRACE <hex record>" lines (read by trace_analyze -x) and empties it
+void trace_dump_hex() {
+    const TraceRecord* records;
+    int first;
+    const int count = trace_ring(&records, &first);
+    for (int i = 0; i < count; i++) {
+        const uint8_t* bytes = (const uint8_t*)&records[(first + i) & (TRACE_RING_RECORDS - 1)];
+        printf("TRACE ");
+        for (int b = 0; b < (int)sizeof(TraceRecord); b++) printf("%02x", bytes[b]);
+        printf("\n");
+    }
+    written = 0;
+}
+
+void reset_trace() {
+    level = 0;
+    written = 0;
+    trace_next_move = -1;
+}
+
+#endif //GOMOKU_TRACE
@@ -0,0 +1,121 @@
+//
+// trace.h
+// Developed by the GAME2 Team.
+// Compile-time optional search tree trace: one binary record per minimax/quiescence node, written when
+// the node returns. Records go to a ring buffer (device and host) or stream to a file (host, trace_open).
+// Enabled by GOMOKU_TRACE (CONFIG_GOMOKU_TRACE on the device), otherwise every macro is empty.
+// host/trace_analyze.c turns a trace into branching factors, move ordering quality and hot subtrees.
+//
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#if defined(CONFIG_GOMOKU_TRACE) && !defined(GOMOKU_TRACE)
+#define GOMOKU_TRACE
+#define TRACE_RING_RECORDS CONFIG_GOMOKU_TRACE_RECORDS
+#endif
+#endif
+
+#ifndef TRACE_RING_RECORDS
+#define TRACE_RING_RECORDS 65536 // records kept by the ring buffer (power of 2)
+#endif
+
+#define TRACE_MAGIC "GTRC"
+#define TRACE_VERSION 1
+
+// record flags
+#define TRACE_QUIESCENCE 0x01 // quiescence search node
+#define TRACE_NULL       0x02 // node of a null move search
+#define TRACE_T_T_HIT    0x04 // position found in the transposition table
+#define TRACE_T_T_CUTOFF 0x08 // returned the transposition table score
+#define TRACE_CUTOFF     0x10 // alpha beta cutoff (searched = index of the cutting move + 1)
+#define TRACE_NULL_PRUNE 0x20 // pruned by the null move search
+#define TRACE_LEAF       0x40 // won position or evaluated without searching moves
+#define TRACE_ABORTED    0x80 // search ran out of time/nodes, the result is meaningless
+
+// one searched node (28 bytes, little endian in files)
+typedef struct TraceRecord {
+    uint32_t key;       // transposition table key
+    int32_t alpha;      // window on entry
+    int32_t beta;
+    int32_t result;
+    uint32_t nodes;     // nodes of the subtree, the node included
+    int8_t depth;       // remaining depth (quiescence: remaining quiescence depth)
+    uint8_t ply;
+    int8_t move;        // move that led to the node (-1 for the root and null moves)
+    int8_t best_move;   // -1 if none
+    uint8_t flags;
+    uint8_t n_of_moves; // moves generated
+    uint8_t searched;   // moves searched
+    uint8_t reserved;
+} TraceRecord;
+
+// file header, followed by the records
+typedef struct TraceHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t record_size;
+} TraceHeader;
+
+#ifdef GOMOKU_TRACE
+
+void trace_enter(int alpha, int beta, int depth, int ply, uint8_t flags);
+
+void trace_exit(int result, bool aborted);
+
+void trace_key(uint32_t key);
+
+void trace_flag(uint8_t flag);
+
+void trace_moves(int n_of_moves);
+
+void trace_searched(int searched);
+
+void trace_best(int move);
+
+bool trace_open(const char* path);
+
+void trace_close();
+
+int trace_ring(const TraceRecord** records, int* first);
+
+void trace_dump_hex();
+
+// starts the trace of a new search: drops the open nodes of a search that was given up (suspended or
+// cancelled) and empties the ring buffer. A trace file keeps its records
+void reset_trace();
+
+extern int trace_next_move;
+
+#define TRACE_ENTER(alpha, beta, depth, ply, flags) trace_enter(alpha, beta, depth, ply, flags)
+#define TRACE_EXIT(result) trace_exit(result, search_aborted)
+#define TRACE_KEY(key) trace_key(key)
+#define TRACE_FLAG(flag) trace_flag(flag)
+#define TRACE_MOVES(n) trace_moves(n)
+#define TRACE_CHILD(move) (trace_next_move = (move))
+#define TRACE_SEARCHED(n) trace_searched(n)
+#define TRACE_BEST(move) trace_best(move)
+#define TRACE_DUMP() trace_dump_hex()
+#define TRACE_RESET() reset_trace()
+
+#else
+
+#define TRACE_ENTER(alpha, beta, depth, ply, flags)
+#define TRACE_EXIT(result)
+#define TRACE_KEY(key)
+#define TRACE_FLAG(flag)
+#define TRACE_MOVES(n)
+#define TRACE_CHILD(move)
+#define TRACE_SEARCHED(n)
+#define TRACE_BEST(move)
+#define TRACE_DUMP()
+#define TRACE_RESET()
+
+#endif //GOMOKU_TRACE
+
+#endif //TRACE_H
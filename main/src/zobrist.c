@@ -5,21 +5,28 @@
 //
 #include <stdlib.h>
 
-
 #include "zobrist.h"
 
-// gives a random uint32
-static uint32_t get32rand() {
-    return
-    ((uint32_t) rand() <<  0 & 0x0000FFFFull) |
-    ((uint32_t) rand() << 16 & 0xFFFF0000ull);
+static uint32_t random_state = 2463534242u; // engine random generator state (never 0)
+
+// seeds the engine random generator (zobrist keys and random moves), call before init_bot for repeatable runs
+void seed_random(const uint32_t seed) {
+    random_state = seed != 0 ? seed : 2463534242u;
+}
+
+// gives a random uint32 (xorshift32)
+uint32_t random32() {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
 }
 
 // initialize the zobrist table with random numbers
 void init_zobrist(zobrist_t * k) {
     for (int i = 0; i < MAX_ZOBRIST_LENGTH; i++) {
         for (int j = 0; j < 1 << BOARD_SIZE; j++) {
-            k->hashtab[i][j] = get32rand();
+            k->hashtab[i][j] = random32();
         }
     }
 }
@@ -19,6 +19,10 @@ typedef struct zobrist_s {
     uint32_t hashtab[MAX_ZOBRIST_LENGTH][1 << BOARD_SIZE] ;
 } zobrist_t;
 
+void seed_random(uint32_t seed);
+
+uint32_t random32();
+
 void init_zobrist(zobrist_t * k);
 
 uint32_t zobrist(const Board *board, const zobrist_t * k);